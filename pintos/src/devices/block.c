@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include "devices/ide.h"
 #include "threads/malloc.h"
+#include "threads/trace.h"
 #include "lib/compression.h"
 
 /* A block device. */
@@ -130,8 +131,10 @@ block_read (struct block *block, block_sector_t sector, void *buffer)
   }
 
   /* Read raw data from disk */
+  TRACE (TRACE_BLOCK_READ_BEGIN, sector, block->type, 0);
   block->ops->read (block->aux, sector, block_buffer);
   block->read_cnt++;
+  TRACE (TRACE_BLOCK_READ_END, sector, block->type, 0);
 
   /* Extract compressed size from first 4 bytes */
   size_t compressed_size = ((size_t)block_buffer[0] << 24) |
@@ -206,8 +209,10 @@ block_write (struct block *block, block_sector_t sector, const void *buffer)
   }
 
   /* Write to disk */
+  TRACE (TRACE_BLOCK_WRITE_BEGIN, sector, block->type, compressed_size);
   block->ops->write (block->aux, sector, block_buffer);
   block->write_cnt++;
+  TRACE (TRACE_BLOCK_WRITE_END, sector, block->type, 0);
 
   /* Clean up */
   if (compressed_size != 0) {
@@ -237,6 +242,20 @@ block_type (struct block *block)
   return block->type;
 }
 
+/* Returns the number of sectors read from BLOCK. */
+unsigned long long
+block_read_cnt (struct block *block)
+{
+  return block->read_cnt;
+}
+
+/* Returns the number of sectors written to BLOCK. */
+unsigned long long
+block_write_cnt (struct block *block)
+{
+  return block->write_cnt;
+}
+
 /* Prints statistics for each block device used for a Pintos role. */
 void
 block_print_stats (void)
@@ -55,6 +55,8 @@ void block_read (struct block *, block_sector_t, void *);
 void block_write (struct block *, block_sector_t, const void *);
 const char *block_name (struct block *);
 enum block_type block_type (struct block *);
+unsigned long long block_read_cnt (struct block *);
+unsigned long long block_write_cnt (struct block *);
 
 /* Statistics. */
 void block_print_stats (void);
@@ -1,16 +1,43 @@
 #include "devices/input.h"
 #include <debug.h>
-#include "devices/intq.h"
+#include <string.h>
 #include "devices/serial.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
 
-/* Stores keys from the keyboard and serial port. */
-static struct intq buffer;
+/* Stores keys from the keyboard and serial port, in a ring
+   buffer.  Head and tail run freely and are reduced modulo
+   INPUT_BUFSIZE, which must be a power of 2, only to index the
+   buffer.  Accessed only with interrupts off.
+
+   The buffer is large enough to hold many lines, so that input
+   piped in over the serial port keeps flowing while a reader
+   works on the last line it got. */
+#define INPUT_BUFSIZE 4096
+static uint8_t buffer[INPUT_BUFSIZE];
+static size_t head;             /* New keys are written here. */
+static size_t tail;             /* Old keys are read here. */
+
+/* Number of line terminators in the buffer. */
+static size_t line_cnt;
+
+/* Readers take turns, so that each gets whole lines.  The one
+   whose turn it is may sleep until WANT keys are buffered or a
+   line is complete. */
+static struct lock read_lock;
+static struct thread *reader;
+static size_t want;
+
+static size_t used (void);
+static bool is_terminator (uint8_t);
+static bool ready (size_t size);
 
 /* Initializes the input buffer. */
 void
 input_init (void)
 {
-  intq_init (&buffer);
+  lock_init (&read_lock);
 }
 
 /* Adds a key to the input buffer.
@@ -19,9 +46,16 @@ void
 input_putc (uint8_t key)
 {
   ASSERT (intr_get_level () == INTR_OFF);
-  ASSERT (!intq_full (&buffer));
+  ASSERT (!input_full ());
 
-  intq_putc (&buffer, key);
+  buffer[head++ % INPUT_BUFSIZE] = key;
+  if (is_terminator (key))
+    line_cnt++;
+  if (reader != NULL && ready (want))
+    {
+      thread_unblock (reader);
+      reader = NULL;
+    }
   serial_notify ();
 }
 
@@ -30,15 +64,64 @@ input_putc (uint8_t key)
 uint8_t
 input_getc (void)
 {
-  enum intr_level old_level;
   uint8_t key;
 
+  input_read (&key, 1, true);
+  return key;
+}
+
+/* Reads keys from the input buffer into DST, stopping after
+   SIZE keys or after a new-line or carriage return, whichever
+   comes first, and returns the number read.  If BLOCK is true,
+   first waits until a whole line, or SIZE keys, can be read.
+   Otherwise, reads only the keys already buffered, which may be
+   none. */
+size_t
+input_read (uint8_t *dst, size_t size, bool block)
+{
+  enum intr_level old_level;
+  size_t cnt, i;
+
+  if (size == 0)
+    return 0;
+
+  lock_acquire (&read_lock);
   old_level = intr_disable ();
-  key = intq_getc (&buffer);
+
+  if (block)
+    while (!ready (size))
+      {
+        reader = thread_current ();
+        want = size;
+        thread_block ();
+      }
+
+  /* Find the end of the first line, if it is complete. */
+  cnt = used () < size ? used () : size;
+  if (line_cnt > 0)
+    for (i = 0; i < cnt; i++)
+      if (is_terminator (buffer[(tail + i) % INPUT_BUFSIZE]))
+        {
+          cnt = i + 1;
+          line_cnt--;
+          break;
+        }
+
+  /* Copy in at most two pieces, on either side of the wrap. */
+  for (i = 0; i < cnt; )
+    {
+      size_t ofs = tail % INPUT_BUFSIZE;
+      size_t n = cnt - i < INPUT_BUFSIZE - ofs ? cnt - i : INPUT_BUFSIZE - ofs;
+      memcpy (dst + i, buffer + ofs, n);
+      tail += n;
+      i += n;
+    }
   serial_notify ();
+
   intr_set_level (old_level);
+  lock_release (&read_lock);
 
-  return key;
+  return cnt;
 }
 
 /* Returns true if the input buffer is full,
@@ -48,5 +131,28 @@ bool
 input_full (void)
 {
   ASSERT (intr_get_level () == INTR_OFF);
-  return intq_full (&buffer);
+  return used () == INPUT_BUFSIZE;
+}
+
+/* Returns the number of keys in the input buffer. */
+static size_t
+used (void)
+{
+  return head - tail;
+}
+
+/* Returns true if KEY ends a line. */
+static bool
+is_terminator (uint8_t key)
+{
+  return key == '\n' || key == '\r';
+}
+
+/* Returns true if a read of SIZE keys can be satisfied without
+   waiting: a whole line is buffered, or SIZE keys are, or the
+   buffer is full. */
+static bool
+ready (size_t size)
+{
+  return line_cnt > 0 || used () >= size || used () == INPUT_BUFSIZE;
 }
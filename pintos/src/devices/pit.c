@@ -1,6 +1,7 @@
 #include "devices/pit.h"
 #include <debug.h>
 #include <stdint.h>
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 
@@ -11,8 +12,12 @@
 #define PIT_PORT_CONTROL          0x43                /* Control port. */
 #define PIT_PORT_COUNTER(CHANNEL) (0x40 + (CHANNEL))  /* Counter port. */
 
-/* PIT cycles per second. */
-#define PIT_HZ 1193180
+/* Port that gates channel 2 and reports its output, shared with
+   the speaker. */
+#define PIT_PORT_GATE2 0x61
+#define GATE2_ENABLE 0x01               /* Let channel 2 count. */
+#define GATE2_SPEAKER 0x02              /* Connect it to the speaker. */
+#define GATE2_OUT 0x20                  /* Channel 2 output (read-only). */
 
 /* Configure the given CHANNEL in the PIT.  In a PC, the PIT's
    three output channels are hooked up like this:
@@ -81,3 +86,37 @@ pit_configure_channel (int channel, int mode, int frequency)
   outb (PIT_PORT_COUNTER (channel), count >> 8);
   intr_set_level (old_level);
 }
+
+/* Counts COUNT PIT cycles on channel 2, with the speaker
+   disconnected, and returns how many time-stamp counter cycles
+   went by meanwhile.  Busy-waits, with interrupts off, for
+   COUNT / PIT_HZ seconds.  Used to calibrate the time-stamp
+   counter without waiting for timer interrupts. */
+uint64_t
+pit_count_tsc (uint16_t count)
+{
+  enum intr_level old_level;
+  uint64_t start, end;
+  uint8_t gate;
+
+  ASSERT (count > 0);
+
+  old_level = intr_disable ();
+  gate = inb (PIT_PORT_GATE2);
+  outb (PIT_PORT_GATE2, (gate & ~GATE2_SPEAKER) | GATE2_ENABLE);
+
+  /* Mode 0 drives the output low, counts down from COUNT once
+     the count is loaded, then drives the output high. */
+  outb (PIT_PORT_CONTROL, (2 << 6) | 0x30 | (0 << 1));
+  outb (PIT_PORT_COUNTER (2), count);
+  outb (PIT_PORT_COUNTER (2), count >> 8);
+  start = rdtsc ();
+  while ((inb (PIT_PORT_GATE2) & GATE2_OUT) == 0)
+    continue;
+  end = rdtsc ();
+
+  outb (PIT_PORT_GATE2, gate);
+  intr_set_level (old_level);
+
+  return end - start;
+}
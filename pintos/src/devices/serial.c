@@ -1,7 +1,8 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <stdio.h>
+#include <string.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -33,6 +34,13 @@
 #define MCR_REG (IO_BASE + 4)   /* MODEM Control Register. */
 #define LSR_REG (IO_BASE + 5)   /* Line Status Register (read-only). */
 
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable FIFOs. */
+#define FCR_CLEAR 0x06          /* Clear receive and transmit FIFOs. */
+
+/* Bytes the transmit FIFO holds once THR reports empty. */
+#define TX_FIFO_SIZE 16
+
 /* Interrupt Enable Register bits. */
 #define IER_RECV 0x01           /* Interrupt when data received. */
 #define IER_XMIT 0x02           /* Interrupt when transmit finishes. */
@@ -51,9 +59,27 @@
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
-
+/* Data to be transmitted, in a ring buffer drained by the
+   serial interrupt handler.  Head and tail run freely and are
+   reduced modulo TXQ_SIZE, which must be a power of 2, only to
+   index the buffer.  Accessed only with interrupts off. */
+#define TXQ_SIZE 8192
+static uint8_t txq[TXQ_SIZE];
+static size_t txq_head;         /* New data is written here. */
+static size_t txq_tail;         /* Old data is read here. */
+
+/* Threads waiting for room in the ring, and how many of them
+   there are.  They are woken once it is half empty, so that a
+   writer that outruns the port blocks only once per half
+   ring. */
+static struct semaphore txq_room;
+static int txq_waiter_cnt;
+
+/* Statistics. */
+static long long stall_cnt;     /* Times a writer found the ring full. */
+
+static size_t txq_used (void);
+static uint8_t txq_getc (void);
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
@@ -71,7 +97,6 @@ init_poll (void)
   outb (FCR_REG, 0);                    /* Disable FIFO. */
   set_serial (9600);                    /* 9.6 kbps, N-8-1. */
   outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-  intq_init (&txq);
   mode = POLL;
 }
 
@@ -87,6 +112,11 @@ serial_init_queue (void)
     init_poll ();
   ASSERT (mode == POLL);
 
+  /* With the FIFOs on, each transmit interrupt can send a
+     burst of bytes instead of one. */
+  outb (FCR_REG, FCR_ENABLE | FCR_CLEAR);
+
+  sema_init (&txq_room, 0);
   intr_register_ext (0x20 + 4, serial_interrupt, "serial");
   mode = QUEUE;
   old_level = intr_disable ();
@@ -97,34 +127,64 @@ serial_init_queue (void)
 /* Sends BYTE to the serial port. */
 void
 serial_putc (uint8_t byte)
+{
+  serial_putbuf (&byte, 1);
+}
+
+/* Sends the SIZE bytes in BUFFER to the serial port.  Once
+   interrupt-driven I/O is set up, this only copies them into the
+   transmit ring, unless the ring is full. */
+void
+serial_putbuf (const uint8_t *buffer, size_t size)
 {
   enum intr_level old_level = intr_disable ();
 
   if (mode != QUEUE)
     {
       /* If we're not set up for interrupt-driven I/O yet,
-         use dumb polling to transmit a byte. */
+         use dumb polling to transmit each byte. */
       if (mode == UNINIT)
         init_poll ();
-      putc_poll (byte);
+      while (size-- > 0)
+        putc_poll (*buffer++);
     }
   else
-    {
-      /* Otherwise, queue a byte and update the interrupt enable
-         register. */
-      if (old_level == INTR_OFF && intq_full (&txq))
-        {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq));
-        }
-
-      intq_putc (&txq, byte);
-      write_ier ();
-    }
+    while (size > 0)
+      {
+        size_t ofs = txq_head % TXQ_SIZE;
+        size_t n = TXQ_SIZE - txq_used ();
+
+        if (n == 0)
+          {
+            stall_cnt++;
+            if (old_level == INTR_OFF)
+              {
+                /* Interrupts are off and the transmit ring is
+                   full.  If we wanted to wait for the ring to
+                   empty, we'd have to reenable interrupts.
+                   That's impolite, so we'll send a character via
+                   polling instead. */
+                putc_poll (txq_getc ());
+              }
+            else
+              {
+                txq_waiter_cnt++;
+                sema_down (&txq_room);
+              }
+            continue;
+          }
+
+        /* Copy as much as fits without wrapping around. */
+        if (n > size)
+          n = size;
+        if (n > TXQ_SIZE - ofs)
+          n = TXQ_SIZE - ofs;
+        memcpy (txq + ofs, buffer, n);
+        txq_head += n;
+        buffer += n;
+        size -= n;
+        write_ier ();
+      }
 
   intr_set_level (old_level);
 }
@@ -135,11 +195,35 @@ void
 serial_flush (void)
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  while (txq_used () > 0)
+    putc_poll (txq_getc ());
   intr_set_level (old_level);
 }
 
+/* Prints serial port statistics. */
+void
+serial_print_stats (void)
+{
+  printf ("Serial: %lld stalls on a full transmit buffer\n", stall_cnt);
+}
+
+/* Returns the number of bytes in the transmit ring. */
+static size_t
+txq_used (void)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  return txq_head - txq_tail;
+}
+
+/* Removes and returns the oldest byte in the transmit ring,
+   which must not be empty. */
+static uint8_t
+txq_getc (void)
+{
+  ASSERT (txq_used () > 0);
+  return txq[txq_tail++ % TXQ_SIZE];
+}
+
 /* The fullness of the input buffer may have changed.  Reassess
    whether we should block receive interrupts.
    Called by the input buffer routines when characters are added
@@ -182,7 +266,7 @@ write_ier (void)
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty (&txq))
+  if (txq_used () > 0)
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -218,10 +302,20 @@ serial_interrupt (struct intr_frame *f UNUSED)
   while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
     input_putc (inb (RBR_REG));
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0)
-    outb (THR_REG, intq_getc (&txq));
+  /* Whenever the transmit FIFO is empty, refill it from the
+     transmit ring. */
+  while (txq_used () > 0 && (inb (LSR_REG) & LSR_THRE) != 0)
+    {
+      int i;
+
+      for (i = 0; i < TX_FIFO_SIZE && txq_used () > 0; i++)
+        outb (THR_REG, txq_getc ());
+    }
+
+  /* Wake writers waiting for room once there is plenty of it. */
+  if (txq_used () <= TXQ_SIZE / 2)
+    for (; txq_waiter_cnt > 0; txq_waiter_cnt--)
+      sema_up (&txq_room);
 
   /* Update interrupt enable register based on queue status. */
   write_ier ();
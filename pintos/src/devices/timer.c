@@ -4,7 +4,9 @@
 #include <round.h>
 #include <stdio.h>
 #include "devices/pit.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
+#include "threads/profile.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 
@@ -24,7 +26,20 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Time-stamp counter frequency, in Hz, and the factor that
+   converts its cycles to nanoseconds, with NS_SHIFT fractional
+   bits.  Initialized by timer_calibrate(). */
+#define NS_SHIFT 24
+#define MIN_TSC_HZ (1000000000 >> (32 - NS_SHIFT))  /* ~3.9 MHz. */
+static uint64_t tsc_hz;
+static uint64_t ns_per_cycle;
+
+/* Time-stamp counter at timer_init(), from which timer_ns()
+   counts. */
+static uint64_t tsc_base;
+
 static intr_handler_func timer_interrupt;
+static void calibrate_tsc (void);
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
@@ -35,19 +50,55 @@ static void real_time_delay (int64_t num, int32_t denom);
 void
 timer_init (void)
 {
+  tsc_base = rdtsc ();
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Loops per second given by timer_set_calibration(), or 0. */
+static uint64_t cached_loops_per_sec;
+
+/* Makes timer_calibrate() use LOOPS_PER_SEC, as printed by an
+   earlier calibration on the same machine, instead of measuring.
+   Calibration busy-waits for about a dozen timer ticks. */
+void
+timer_set_calibration (uint64_t loops_per_sec)
+{
+  cached_loops_per_sec = loops_per_sec;
+}
+
+/* Time-stamp counter frequency given by timer_set_tsc_hz(), or
+   0. */
+static uint64_t cached_tsc_hz;
+
+/* Makes timer_calibrate() use TSC_HZ, as printed by an earlier
+   calibration on the same machine, as the time-stamp counter
+   frequency instead of measuring it. */
+void
+timer_set_tsc_hz (uint64_t hz)
+{
+  cached_tsc_hz = hz;
+}
+
+/* Calibrates the time-stamp counter, used by timer_ns(), and
+   loops_per_tick, used to implement brief delays. */
 void
 timer_calibrate (void)
 {
   unsigned high_bit, test_bit;
 
   ASSERT (intr_get_level () == INTR_ON);
+  calibrate_tsc ();
   printf ("Calibrating timer...  ");
 
+  if (cached_loops_per_sec / TIMER_FREQ > 0)
+    {
+      loops_per_tick = cached_loops_per_sec / TIMER_FREQ;
+      printf ("%'"PRIu64" loops/s (cached).\n",
+              (uint64_t) loops_per_tick * TIMER_FREQ);
+      return;
+    }
+
   /* Approximate loops_per_tick as the largest power-of-two
      still less than one timer tick. */
   loops_per_tick = 1u << 10;
@@ -84,6 +135,38 @@ timer_elapsed (int64_t then)
   return timer_ticks () - then;
 }
 
+/* Returns the number of nanoseconds since timer_init(), from the
+   time-stamp counter.  Cheap enough to time very short events:
+   it neither disables interrupts nor divides.  Returns 0 until
+   timer_calibrate() has run. */
+uint64_t
+timer_ns (void)
+{
+  return timer_cycles_to_ns (rdtsc () - tsc_base);
+}
+
+/* Converts CYCLES of the time-stamp counter to nanoseconds.
+   Returns 0 until timer_calibrate() has run. */
+uint64_t
+timer_cycles_to_ns (uint64_t cycles)
+{
+  /* Multiply the high and low halves separately, so that the
+     64-bit products cannot overflow.  That takes NS_PER_CYCLE
+     below 2**32, that is, a time-stamp counter faster than
+     MIN_TSC_HZ, which calibrate_tsc() checks. */
+  uint64_t high = (cycles >> 32) * ns_per_cycle;
+  uint64_t low = (cycles & 0xffffffff) * ns_per_cycle;
+  return (high << (32 - NS_SHIFT)) + (low >> NS_SHIFT);
+}
+
+/* Returns the time-stamp counter frequency in Hz, or 0 if
+   timer_calibrate() has not run yet. */
+uint64_t
+timer_tsc_hz (void)
+{
+  return tsc_hz;
+}
+
 /* Sleeps for approximately TICKS timer ticks.  Interrupts must
    be turned on. */
 void
@@ -168,12 +251,33 @@ timer_print_stats (void)
 
 /* Timer interrupt handler. */
 static void
-timer_interrupt (struct intr_frame *args UNUSED)
+timer_interrupt (struct intr_frame *args)
 {
   ticks++;
+  profile_sample (args);
   thread_tick ();
 }
 
+/* Measures the time-stamp counter frequency against channel 2 of
+   the PIT, over 10 ms, unless timer_set_tsc_hz() supplied it. */
+static void
+calibrate_tsc (void)
+{
+  const uint16_t count = PIT_HZ / 100;
+
+  if (cached_tsc_hz > 0)
+    tsc_hz = cached_tsc_hz;
+  else
+    tsc_hz = pit_count_tsc (count) * PIT_HZ / count;
+  if (tsc_hz > 0)
+    {
+      ASSERT (tsc_hz > MIN_TSC_HZ);
+      ns_per_cycle = ((uint64_t) 1000000000 << NS_SHIFT) / tsc_hz;
+    }
+  printf ("Time-stamp counter: %'"PRIu64" Hz%s.\n",
+          tsc_hz, cached_tsc_hz > 0 ? " (cached)" : "");
+}
+
 /* Returns true if LOOPS iterations waits for more than one timer
    tick, otherwise false. */
 static bool
@@ -8,11 +8,18 @@
 #define TIMER_FREQ 100
 
 void timer_init (void);
+void timer_set_calibration (uint64_t loops_per_sec);
+void timer_set_tsc_hz (uint64_t hz);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
 
+/* High-resolution clock. */
+uint64_t timer_ns (void);
+uint64_t timer_cycles_to_ns (uint64_t cycles);
+uint64_t timer_tsc_hz (void);
+
 /* Sleep and yield the CPU to other threads. */
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
@@ -1,6 +1,8 @@
 /* cat.c
 
-   Prints files specified on command line to the console. */
+   Prints files specified on command line to the console, or
+   copies standard input to standard output if none are given,
+   so that it can sit in a pipeline. */
 
 #include <stdio.h>
 #include <syscall.h>
@@ -11,6 +13,15 @@ main (int argc, char *argv[])
   bool success = true;
   int i;
 
+  if (argc < 2)
+    {
+      char buffer[1024];
+      int bytes_read;
+      while ((bytes_read = read (STDIN_FILENO, buffer, sizeof buffer)) > 0)
+        write (STDOUT_FILENO, buffer, bytes_read);
+      return EXIT_SUCCESS;
+    }
+
   for (i = 1; i < argc; i++)
     {
       int fd = open (argv[i]);
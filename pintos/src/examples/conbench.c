@@ -0,0 +1,79 @@
+/* conbench.c
+
+   Measures console output throughput.  Writes KB kilobytes of
+   text lines to standard output in CHUNK-byte writes and reports
+   the elapsed time-stamp-counter cycles.  Without a CHUNK
+   argument, sweeps a range of chunk sizes.
+
+   Usage: conbench [KB [CHUNK]] */
+
+#include <cpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define MAX_CHUNK 4096
+
+static char buffer[MAX_CHUNK];
+
+/* Writes KB kilobytes to standard output in CHUNK-byte writes
+   and returns the cycles taken. */
+static uint64_t
+run (int kb, int chunk)
+{
+  unsigned total = (unsigned) kb * 1024;
+  unsigned sent;
+  uint64_t start;
+
+  start = rdtsc ();
+  for (sent = 0; sent < total; sent += chunk)
+    {
+      int n = total - sent < (unsigned) chunk ? (int) (total - sent) : chunk;
+      write (STDOUT_FILENO, buffer, n);
+    }
+  return rdtsc () - start;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const int chunks[] = {1, 64, 512, MAX_CHUNK};
+  uint64_t cycles[sizeof chunks / sizeof *chunks];
+  int kb = 64;
+  size_t i;
+
+  if (argc > 1)
+    kb = atoi (argv[1]);
+
+  /* Lines of 64 characters, so that the display scrolls. */
+  for (i = 0; i < sizeof buffer; i++)
+    buffer[i] = i % 64 == 63 ? '\n' : 'a' + i % 26;
+
+  if (argc > 2)
+    {
+      int chunk = atoi (argv[2]);
+      uint64_t c;
+
+      if (chunk < 1 || chunk > MAX_CHUNK)
+        {
+          printf ("conbench: chunk must be between 1 and %d\n", MAX_CHUNK);
+          return EXIT_FAILURE;
+        }
+      c = run (kb, chunk);
+      printf ("conbench: chunk %4d: %d kB in %llu cycles, "
+              "%llu bytes/kcycle\n", chunk, kb, c,
+              c > 0 ? (uint64_t) kb * 1024 * 1000 / c : 0);
+      return EXIT_SUCCESS;
+    }
+
+  /* Report only after all the runs, so the results are not lost
+     among the output being timed. */
+  for (i = 0; i < sizeof chunks / sizeof *chunks; i++)
+    cycles[i] = run (kb, chunks[i]);
+  for (i = 0; i < sizeof chunks / sizeof *chunks; i++)
+    printf ("conbench: chunk %4d: %d kB in %llu cycles, "
+            "%llu bytes/kcycle\n", chunks[i], kb, cycles[i],
+            cycles[i] > 0 ? (uint64_t) kb * 1024 * 1000 / cycles[i] : 0);
+  return EXIT_SUCCESS;
+}
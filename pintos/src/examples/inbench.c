@@ -0,0 +1,51 @@
+/* inbench.c
+
+   Measures console input throughput.  Reads standard input until
+   KB kilobytes have arrived and reports the elapsed
+   time-stamp-counter cycles and how many reads it took.  Meant
+   to be fed over the serial port, for example:
+
+     base64 /dev/urandom | head -c 1M \
+       | pintos -v -k -- -q run 'inbench 1024'
+
+   Usage: inbench [KB] */
+
+#include <cpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+static char buffer[4096];
+
+int
+main (int argc, char *argv[])
+{
+  unsigned total, received = 0, reads = 0;
+  uint64_t start, cycles;
+  int kb = 64;
+
+  if (argc > 1)
+    kb = atoi (argv[1]);
+  total = (unsigned) kb * 1024;
+
+  start = 0;
+  while (received < total)
+    {
+      int n = read (STDIN_FILENO, buffer, sizeof buffer);
+      if (n <= 0)
+        break;
+
+      /* Start the clock at the first input, so that the time
+         before any arrives does not count. */
+      if (reads++ == 0)
+        start = rdtsc ();
+      received += n;
+    }
+  cycles = rdtsc () - start;
+
+  printf ("inbench: %u bytes in %u reads, %u bytes/read, %llu cycles, "
+          "%llu bytes/kcycle\n", received, reads,
+          reads > 0 ? received / reads : 0, cycles,
+          cycles > 0 ? (uint64_t) received * 1000 / cycles : 0);
+  return received >= total ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+/* membench.c
+
+   Measures memcpy(), memset(), memcmp() and strlen() from the
+   C library, which the kernel shares, in bytes per cycle of the
+   time-stamp counter, over a range of sizes and for each
+   alignment of the source relative to the destination.
+
+   Usage: membench [ITERATIONS] */
+
+#include <cpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define MAX_SIZE 16384
+
+static char dst_buf[MAX_SIZE + 8];
+static char src_buf[MAX_SIZE + 8];
+
+enum op { OP_MEMCPY, OP_MEMSET, OP_MEMCMP, OP_STRLEN, OP_CNT };
+static const char *op_names[OP_CNT] = {"memcpy", "memset", "memcmp", "strlen"};
+
+/* Runs OP on SIZE bytes at offset DST_OFS of dst_buf and SRC_OFS
+   of src_buf ITERATIONS times.  Returns the average number of
+   cycles per call. */
+static uint64_t
+run (enum op op, size_t size, int dst_ofs, int src_ofs, int iterations)
+{
+  char *dst = dst_buf + dst_ofs;
+  char *src = src_buf + src_ofs;
+  volatile size_t sink = 0;
+  uint64_t start;
+  int i;
+
+  memset (dst_buf, 'x', sizeof dst_buf);
+  memset (src_buf, 'x', sizeof src_buf);
+  src[size - 1] = '\0';
+  dst[size - 1] = '\0';
+
+  start = rdtsc ();
+  for (i = 0; i < iterations; i++)
+    switch (op)
+      {
+      case OP_MEMCPY:
+        memcpy (dst, src, size);
+        break;
+      case OP_MEMSET:
+        memset (dst, i, size);
+        break;
+      case OP_MEMCMP:
+        sink += memcmp (dst, src, size);
+        break;
+      case OP_STRLEN:
+        sink += strlen (src);
+        break;
+      default:
+        NOT_REACHED ();
+      }
+  return (rdtsc () - start) / iterations;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const size_t sizes[] = {8, 16, 64, 512, 4096, MAX_SIZE};
+  int iterations = argc > 1 ? atoi (argv[1]) : 100;
+  enum op op;
+  size_t i;
+  int align;
+
+  if (iterations < 1)
+    {
+      printf ("membench: ITERATIONS must be positive\n");
+      return EXIT_FAILURE;
+    }
+
+  printf ("membench: bytes/cycle, by source alignment 0...3 "
+          "(destination word aligned)\n");
+  for (op = 0; op < OP_CNT; op++)
+    for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+      {
+        printf ("%-7s %6zu:", op_names[op], sizes[i]);
+        for (align = 0; align < 4; align++)
+          {
+            uint64_t cycles = run (op, sizes[i], 0, align, iterations);
+            uint64_t centi = cycles > 0 ? sizes[i] * 100 / cycles : 0;
+            printf (" %3llu.%02llu", centi / 100, centi % 100);
+          }
+        printf ("\n");
+      }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+/* pipebench.c
+
+   Measures pipe throughput.  Starts a copy of itself as a sink
+   that reads its standard input from a pipe until end of file,
+   pushes KB kilobytes through the pipe in CHUNK-byte writes, and
+   reports the elapsed time-stamp-counter cycles.  Without a
+   CHUNK argument, sweeps a range of chunk sizes.
+
+   Usage: pipebench [KB [CHUNK]] */
+
+#include <cpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define MAX_CHUNK 16384
+
+static char buffer[MAX_CHUNK];
+
+/* Reads standard input until end of file and returns the number
+   of kilobytes read as the exit code. */
+static int
+sink (void)
+{
+  unsigned total = 0;
+  int n;
+
+  while ((n = read (STDIN_FILENO, buffer, sizeof buffer)) > 0)
+    total += n;
+  return total / 1024;
+}
+
+/* Pushes KB kilobytes through a pipe to a sink process in
+   CHUNK-byte writes and prints the throughput. */
+static bool
+run (const char *self, int kb, int chunk)
+{
+  char cmd[64];
+  uint64_t start, cycles;
+  unsigned total = (unsigned) kb * 1024;
+  unsigned sent;
+  int fds[2];
+  pid_t pid;
+  int received;
+
+  if (!pipe (fds))
+    {
+      printf ("pipebench: pipe failed\n");
+      return false;
+    }
+  snprintf (cmd, sizeof cmd, "%s sink", self);
+  pid = exec_redirect (cmd, fds[0], -1);
+  close (fds[0]);
+  if (pid == PID_ERROR)
+    {
+      printf ("pipebench: exec failed\n");
+      close (fds[1]);
+      return false;
+    }
+
+  start = rdtsc ();
+  for (sent = 0; sent < total; sent += chunk)
+    {
+      int n = total - sent < (unsigned) chunk ? (int) (total - sent) : chunk;
+      if (write (fds[1], buffer, n) != n)
+        break;
+    }
+  close (fds[1]);
+  received = wait (pid);
+  cycles = rdtsc () - start;
+
+  printf ("pipebench: chunk %5d: %d kB in %llu cycles, %llu bytes/kcycle\n",
+          chunk, received, cycles,
+          cycles > 0 ? (uint64_t) total * 1000 / cycles : 0);
+  return received == kb;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const int chunks[] = {64, 512, 4096, MAX_CHUNK};
+  bool success = true;
+  int kb = 1024;
+  size_t i;
+
+  if (argc == 2 && !strcmp (argv[1], "sink"))
+    return sink ();
+
+  if (argc > 1)
+    kb = atoi (argv[1]);
+  memset (buffer, 'p', sizeof buffer);
+
+  if (argc > 2)
+    {
+      int chunk = atoi (argv[2]);
+      if (chunk < 1 || chunk > MAX_CHUNK)
+        {
+          printf ("pipebench: chunk must be between 1 and %d\n", MAX_CHUNK);
+          return EXIT_FAILURE;
+        }
+      success = run (argv[0], kb, chunk);
+    }
+  else
+    for (i = 0; i < sizeof chunks / sizeof *chunks; i++)
+      success = run (argv[0], kb, chunks[i]) && success;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
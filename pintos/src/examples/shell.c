@@ -3,8 +3,12 @@
 #include <string.h>
 #include <syscall.h>
 
+/* Maximum number of commands in a pipeline. */
+#define MAX_STAGES 8
+
 static void read_line (char line[], size_t);
 static bool backspace (char **pos, char line[]);
+static void run_pipeline (char *line);
 
 int
 main (void)
@@ -30,6 +34,8 @@ main (void)
         {
           /* Empty command. */
         }
+      else if (strchr (command, '|') != NULL)
+        run_pipeline (command);
       else
         {
           pid_t pid = exec (command);
@@ -44,6 +50,64 @@ main (void)
   return EXIT_SUCCESS;
 }
 
+/* Runs the `|'-separated commands in LINE concurrently, with
+   each command's standard output connected through a pipe to the
+   standard input of the next, then waits for all of them. */
+static void
+run_pipeline (char *line)
+{
+  char *stages[MAX_STAGES];
+  pid_t pids[MAX_STAGES];
+  int stage_cnt = 0;
+  int in_fd = -1;
+  char *stage, *save_ptr;
+  int i;
+
+  for (stage = strtok_r (line, "|", &save_ptr); stage != NULL;
+       stage = strtok_r (NULL, "|", &save_ptr))
+    {
+      if (stage_cnt == MAX_STAGES)
+        {
+          printf ("pipeline too long\n");
+          return;
+        }
+      while (*stage == ' ')
+        stage++;
+      stages[stage_cnt++] = stage;
+    }
+
+  for (i = 0; i < stage_cnt; i++)
+    {
+      bool last = i == stage_cnt - 1;
+      int fds[2] = {-1, -1};
+
+      if (!last && !pipe (fds))
+        {
+          printf ("pipe failed\n");
+          stage_cnt = i;
+          break;
+        }
+
+      pids[i] = exec_redirect (stages[i], in_fd, last ? -1 : fds[1]);
+      if (pids[i] == PID_ERROR)
+        printf ("\"%s\": exec failed\n", stages[i]);
+
+      /* Only the children keep these ends open, so each reader
+         sees end of file once its writer exits. */
+      if (in_fd != -1)
+        close (in_fd);
+      if (!last)
+        close (fds[1]);
+      in_fd = fds[0];
+    }
+  if (in_fd != -1)
+    close (in_fd);
+
+  for (i = 0; i < stage_cnt; i++)
+    if (pids[i] != PID_ERROR)
+      printf ("\"%s\": exit code %d\n", stages[i], wait (pids[i]));
+}
+
 /* Reads a line of input from the user into LINE, which has room
    for SIZE bytes.  Handles backspace and Ctrl+U in the ways
    expected by Unix users.  On return, LINE will always be
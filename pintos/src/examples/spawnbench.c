@@ -0,0 +1,71 @@
+/* spawnbench.c
+
+   Measures the cost of starting a process.  Execs a copy of
+   itself COUNT times, waiting for each copy to exit, and reports
+   the average time-stamp-counter cycles per exec and wait.  The
+   first spawn is reported separately, since it is the one that
+   has to parse the executable and fill the executable cache.
+
+   Usage: spawnbench [COUNT] */
+
+#include <cpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+/* Execs CMD and waits for it.  Returns the elapsed cycles, or 0
+   if the child could not be started or did not exit cleanly. */
+static uint64_t
+spawn (const char *cmd)
+{
+  uint64_t start = rdtsc ();
+  pid_t pid = exec (cmd);
+
+  if (pid == PID_ERROR || wait (pid) != 0)
+    return 0;
+  return rdtsc () - start;
+}
+
+int
+main (int argc, char *argv[])
+{
+  char cmd[64];
+  uint64_t first, total = 0;
+  int count = 100;
+  int i;
+
+  if (argc == 2 && !strcmp (argv[1], "child"))
+    return EXIT_SUCCESS;
+
+  if (argc > 1)
+    count = atoi (argv[1]);
+  if (count < 2)
+    {
+      printf ("spawnbench: COUNT must be at least 2\n");
+      return EXIT_FAILURE;
+    }
+  snprintf (cmd, sizeof cmd, "%s child", argv[0]);
+
+  first = spawn (cmd);
+  if (first == 0)
+    {
+      printf ("spawnbench: exec failed\n");
+      return EXIT_FAILURE;
+    }
+  for (i = 1; i < count; i++)
+    {
+      uint64_t cycles = spawn (cmd);
+      if (cycles == 0)
+        {
+          printf ("spawnbench: exec %d failed\n", i);
+          return EXIT_FAILURE;
+        }
+      total += cycles;
+    }
+
+  printf ("spawnbench: first spawn: %llu cycles\n", first);
+  printf ("spawnbench: %d spawns: %llu cycles per exec+wait\n",
+          count - 1, total / (count - 1));
+  return EXIT_SUCCESS;
+}
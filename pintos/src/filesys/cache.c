@@ -1,8 +1,50 @@
 #include "cache.h"
 #include "filesys/filesys.h"
+#include "filesys/journal.h"
+#include "threads/thread.h"
+#include "threads/trace.h"
 #include <debug.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+/* Warm-up list: the sectors that were hottest, by number of
+   accesses, when the file system was last shut down.  Kept at
+   CACHE_WARMUP_SECTOR, sorted by sector, and prefetched by a
+   background thread at the next boot so that the cache does not
+   start cold.  A file system formatted before the list existed
+   lacks its magic number, and then nothing is saved, because
+   the sector may belong to a file.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+#define WARMUP_MAGIC 0x5741524d         /* "WARM" */
+#define WARMUP_MAX 126
+struct warmup_list
+  {
+    unsigned magic;                     /* WARMUP_MAGIC. */
+    unsigned cnt;                       /* Number of sectors. */
+    block_sector_t sectors[WARMUP_MAX]; /* Sectors, ascending. */
+  };
+
+/* List being prefetched, and whether prefetching should stop.
+   Protected by cache_lock. */
+static struct warmup_list warmup;
+static bool warmup_stopped;
+
+/* Warm-up statistics, protected by cache_lock. */
+static unsigned warmup_prefetched;  /* Sectors prefetched. */
+static unsigned warmup_used;        /* ...then accessed. */
+static unsigned warmup_unused;      /* ...evicted without an access. */
+
+/* Protects every inode's list of dirty blocks and the blocks'
+   DIRTY_LIST members.  Acquired after any block lock. */
+static struct lock dirty_lock;
+
+static void detach_dirty (struct cache_block *);
+static void invalidate_block (struct cache_block *);
+static thread_func warmup_thread;
+static bool prefetch_block (struct block *, block_sector_t);
+static void save_warmup (struct block *);
+
 static void
 stat_update (int mode)
 {
@@ -35,6 +77,7 @@ cache_init (void)
   /* Initialize the locks. */
   lock_init (&cache_lock);
   lock_init (&stat_lock);
+  lock_init (&dirty_lock);
 
   /* Initialize the blocks. */
   lock_acquire (&cache_lock);
@@ -44,6 +87,10 @@ cache_init (void)
       lock_init (&cache_blocks[i].block_lock);
       cache_blocks[i].is_dirty = false;
       cache_blocks[i].is_valid = false;
+      cache_blocks[i].is_pinned = false;
+      cache_blocks[i].dirty_list = NULL;
+      cache_blocks[i].access_cnt = 0;
+      cache_blocks[i].is_prefetched = false;
       list_push_back (&cache_list, &cache_blocks[i].elem);
     }
 
@@ -60,36 +107,71 @@ cache_init (void)
   cache_initialized = true;
 }
 
-/* Find cache block with current sector index, acquire the lock and return the block.
-  If no blocks found, evict least recently used block from cache list, acquire its lock and return the block.*/
-struct cache_block *
-get_cache_block (struct block *fs_device, block_sector_t sector_idx, bool write_optimization)
+/* Removes and returns the least recently used block that the
+   journal has not pinned.  The journal never pins more than
+   JOURNAL_MAX_BLOCKS blocks, so there always is one. */
+static struct cache_block *
+pop_lru_block (void)
 {
-  lock_acquire (&cache_lock);
+  struct list_elem *e;
 
-  for (int i = 0; i < CACHE_SIZE; i++)
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+  for (e = list_begin (&cache_list); e != list_end (&cache_list);
+       e = list_next (e))
     {
-      lock_acquire (&cache_blocks[i].block_lock);
-
-      /* Cache hit case*/
-      if (cache_blocks[i].is_valid && cache_blocks[i].sector_index == sector_idx)
+      struct cache_block *b = list_entry (e, struct cache_block, elem);
+      if (!b->is_pinned)
         {
-          list_remove (&cache_blocks[i].elem);
-          list_push_back (&cache_list, &cache_blocks[i].elem);
-
-          lock_release (&cache_lock);
-          stat_update (HIT);
-          return &cache_blocks[i];
+          list_remove (e);
+          return b;
         }
+    }
+  NOT_REACHED ();
+}
 
+/* Returns the cache block that holds SECTOR_IDX, with its lock
+   acquired, or a null pointer if it is not cached.  The caller
+   must hold cache_lock. */
+static struct cache_block *
+lookup_block (block_sector_t sector_idx)
+{
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+  for (int i = 0; i < CACHE_SIZE; i++)
+    {
+      lock_acquire (&cache_blocks[i].block_lock);
+      if (cache_blocks[i].is_valid && cache_blocks[i].sector_index == sector_idx)
+        return &cache_blocks[i];
       lock_release (&cache_blocks[i].block_lock);
     }
+  return NULL;
+}
 
-  /* Cache miss case*/
-  struct cache_block *lru_block = list_entry (list_pop_front (&cache_list), struct cache_block, elem);
-  lock_acquire (&lru_block->block_lock);
+/* Evicts the least recently used block, loads SECTOR_IDX into
+   it, reading it from disk unless WRITE_OPTIMIZATION, and returns
+   it with its lock acquired.  The caller must hold cache_lock. */
+static struct cache_block *
+load_block (struct block *fs_device, block_sector_t sector_idx, bool write_optimization)
+{
+  /* A block's owner may pin it while we wait for its lock, so
+     check again once we hold it. */
+  struct cache_block *lru_block;
+  for (;;)
+    {
+      lru_block = pop_lru_block ();
+      lock_acquire (&lru_block->block_lock);
+      if (!lru_block->is_pinned)
+        break;
+      list_push_back (&cache_list, &lru_block->elem);
+      lock_release (&lru_block->block_lock);
+    }
 
+  TRACE (TRACE_CACHE_MISS, sector_idx, lru_block->sector_index,
+         lru_block->is_valid && lru_block->is_dirty);
   flush_block (fs_device, lru_block);
+  if (lru_block->is_valid && lru_block->is_prefetched)
+    warmup_unused++;
+  lru_block->is_prefetched = false;
+  lru_block->access_cnt = 0;
 
   /* When whole block is going to be written over, optimization speeds up cache block retrieval by skipping the block read. */
   if (!write_optimization)
@@ -101,14 +183,50 @@ get_cache_block (struct block *fs_device, block_sector_t sector_idx, bool write_
   lru_block->sector_index = sector_idx;
   lru_block->is_valid = true;
   list_push_back (&cache_list, &lru_block->elem);
+  return lru_block;
+}
+
+/* Find cache block with current sector index, acquire the lock and return the block.
+  If no blocks found, evict least recently used block from cache list, acquire its lock and return the block.*/
+struct cache_block *
+get_cache_block (struct block *fs_device, block_sector_t sector_idx, bool write_optimization)
+{
+  lock_acquire (&cache_lock);
+
+  /* Cache hit case*/
+  struct cache_block *hit_block = lookup_block (sector_idx);
+  if (hit_block != NULL)
+    {
+      list_remove (&hit_block->elem);
+      list_push_back (&cache_list, &hit_block->elem);
+      hit_block->access_cnt++;
+      if (hit_block->is_prefetched)
+        {
+          hit_block->is_prefetched = false;
+          warmup_used++;
+        }
+
+      lock_release (&cache_lock);
+      stat_update (HIT);
+      TRACE (TRACE_CACHE_HIT, sector_idx, 0, 0);
+      return hit_block;
+    }
+
+  /* Cache miss case. */
+  struct cache_block *lru_block = load_block (fs_device, sector_idx, write_optimization);
+  lru_block->access_cnt = 1;
 
   lock_release (&cache_lock);
   stat_update (MISS);
   return lru_block;
 }
 
+/* Writes CHUNK_SIZE bytes from SOURCE into the cached copy of
+   SECTOR_IDX, starting OFFSET bytes into it.  If DIRTY_LIST is
+   non-null, the block is added to it, so that cache_sync() on
+   the list writes the block back. */
 void
-cache_write (struct block *fs_device, block_sector_t sector_idx, void *source, off_t offset, int chunk_size)
+cache_write (struct block *fs_device, block_sector_t sector_idx, void *source, off_t offset, int chunk_size, struct list *dirty_list)
 {
   ASSERT (cache_initialized);
   ASSERT (fs_device != NULL);
@@ -125,9 +243,50 @@ cache_write (struct block *fs_device, block_sector_t sector_idx, void *source, o
   ASSERT (cache_block->is_valid);
   memcpy (cache_block->data + offset, source, chunk_size);
   cache_block->is_dirty = true;
+  if (dirty_list != NULL)
+    {
+      lock_acquire (&dirty_lock);
+      if (cache_block->dirty_list == NULL)
+        {
+          cache_block->dirty_list = dirty_list;
+          list_push_back (dirty_list, &cache_block->dirty_elem);
+        }
+      lock_release (&dirty_lock);
+    }
   lock_release (&cache_block->block_lock);
 }
 
+/* Like cache_write(), for a metadata block.  Within a journal
+   transaction, also pins the block, so that it is not written
+   home before the journal commits it, and adds it to the
+   transaction. */
+void
+cache_write_meta (struct block *fs_device, block_sector_t sector_idx, const void *source, off_t offset, int chunk_size)
+{
+  ASSERT (cache_initialized);
+  ASSERT (fs_device != NULL);
+  ASSERT (offset + chunk_size <= BLOCK_SECTOR_SIZE);
+
+  struct cache_block *cache_block;
+  bool journaled = journal_running ();
+
+  if (offset == 0 && chunk_size >= BLOCK_SECTOR_SIZE)
+    cache_block = get_cache_block (fs_device, sector_idx, true);
+  else
+    cache_block = get_cache_block (fs_device, sector_idx, false);
+
+  ASSERT (lock_held_by_current_thread (&cache_block->block_lock));
+  ASSERT (cache_block->is_valid);
+  memcpy (cache_block->data + offset, source, chunk_size);
+  cache_block->is_dirty = true;
+  if (journaled)
+    cache_block->is_pinned = true;
+  lock_release (&cache_block->block_lock);
+
+  if (journaled)
+    journal_add (sector_idx);
+}
+
 void
 cache_read (struct block *fs_device, block_sector_t sector_idx, void *destination, off_t offset, int chunk_size)
 {
@@ -143,9 +302,127 @@ cache_read (struct block *fs_device, block_sector_t sector_idx, void *destinatio
   lock_release (&cache_block->block_lock);
 }
 
+/* Reads sector SECTOR_IDX into DESTINATION, a whole sector's
+   worth of bytes, without caching it.  Takes the cached copy if
+   there is one, since it may be newer than the disk.  The caller
+   must hold the lock of the inode that owns the sector, which
+   keeps it from being written through the cache meanwhile. */
+void
+cache_read_direct (struct block *fs_device, block_sector_t sector_idx, void *destination)
+{
+  ASSERT (cache_initialized);
+
+  lock_acquire (&cache_lock);
+  struct cache_block *cache_block = lookup_block (sector_idx);
+  lock_release (&cache_lock);
+
+  if (cache_block != NULL)
+    {
+      memcpy (destination, cache_block->data, BLOCK_SECTOR_SIZE);
+      lock_release (&cache_block->block_lock);
+    }
+  else
+    {
+      block_read (fs_device, sector_idx, destination);
+      stat_update (READ);
+    }
+}
+
+/* Writes SOURCE, a whole sector's worth of bytes, to sector
+   SECTOR_IDX without caching it.  Drops any cached copy, which
+   is now stale, and makes its cache block the next one reused,
+   so that streaming writes recycle a single block instead of
+   evicting others.  Returns false, writing nothing, if the
+   journal has the cached copy pinned, in which case the caller
+   must write through the cache instead.  The caller must hold
+   the lock of the inode that owns the sector. */
+bool
+cache_write_direct (struct block *fs_device, block_sector_t sector_idx, const void *source)
+{
+  ASSERT (cache_initialized);
+
+  lock_acquire (&cache_lock);
+  struct cache_block *cache_block = lookup_block (sector_idx);
+  if (cache_block != NULL)
+    {
+      bool pinned = cache_block->is_pinned;
+      if (!pinned)
+        invalidate_block (cache_block);
+      lock_release (&cache_block->block_lock);
+      if (pinned)
+        {
+          lock_release (&cache_lock);
+          return false;
+        }
+    }
+  lock_release (&cache_lock);
+
+  block_write (fs_device, sector_idx, source);
+  stat_update (WRITE);
+
+  /* Cache warmup may have read the old contents in meanwhile. */
+  cache_discard (sector_idx);
+  return true;
+}
+
+/* Drops the cached copy of SECTOR_IDX, if there is one, without
+   writing it back.  A block that the journal has pinned stays. */
+void
+cache_discard (block_sector_t sector_idx)
+{
+  ASSERT (cache_initialized);
+
+  lock_acquire (&cache_lock);
+  struct cache_block *cache_block = lookup_block (sector_idx);
+  if (cache_block != NULL)
+    {
+      if (!cache_block->is_pinned)
+        invalidate_block (cache_block);
+      lock_release (&cache_block->block_lock);
+    }
+  lock_release (&cache_lock);
+}
+
+/* Marks CACHE_BLOCK invalid and clean, and makes it the next
+   one reused.  The caller must hold cache_lock and the block's
+   lock. */
+static void
+invalidate_block (struct cache_block *cache_block)
+{
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+  cache_block->is_valid = false;
+  cache_block->is_dirty = false;
+  cache_block->is_prefetched = false;
+  detach_dirty (cache_block);
+  list_remove (&cache_block->elem);
+  list_push_front (&cache_list, &cache_block->elem);
+}
+
+/* Lets the cache write the block for SECTOR_IDX home again,
+   after the journal has committed it. */
+void
+cache_unpin (block_sector_t sector_idx)
+{
+  lock_acquire (&cache_lock);
+  for (int i = 0; i < CACHE_SIZE; i++)
+    if (cache_blocks[i].is_valid && cache_blocks[i].sector_index == sector_idx)
+      {
+        lock_acquire (&cache_blocks[i].block_lock);
+        cache_blocks[i].is_pinned = false;
+        lock_release (&cache_blocks[i].block_lock);
+        break;
+      }
+  lock_release (&cache_lock);
+}
+
+/* Writes CACHE_BLOCK to disk if it is dirty, unless the journal
+   has pinned it. */
 void
 flush_block (struct block *fs_device, struct cache_block *cache_block)
 {
+  if (cache_block->is_pinned)
+    return;
+
   if (cache_block->is_valid && cache_block->is_dirty)
     {
       block_write (fs_device, cache_block->sector_index, cache_block->data);
@@ -153,30 +430,148 @@ flush_block (struct block *fs_device, struct cache_block *cache_block)
     }
 
   cache_block->is_dirty = false;
+  detach_dirty (cache_block);
 }
 
-/* (Not yet) used for write-behind functionality. */
+/* Removes CACHE_BLOCK from the dirty list it is on, if any. */
+static void
+detach_dirty (struct cache_block *cache_block)
+{
+  lock_acquire (&dirty_lock);
+  if (cache_block->dirty_list != NULL)
+    {
+      list_remove (&cache_block->dirty_elem);
+      cache_block->dirty_list = NULL;
+    }
+  lock_release (&dirty_lock);
+}
+
+/* Writes every dirty, unpinned block in the cache back to
+   FS_DEVICE. */
 void
 cache_flush (struct block *fs_device)
 {
   lock_acquire (&cache_lock);
   for (int i = 0; i < CACHE_SIZE; i++)
     {
+      lock_acquire (&cache_blocks[i].block_lock);
       flush_block (fs_device, &cache_blocks[i]);
+      lock_release (&cache_blocks[i].block_lock);
     }
   lock_release (&cache_lock);
 }
 
-/* Flush and invalidate all cache blocks.*/
+/* A block to write back in cache_sync(). */
+struct sync_entry
+  {
+    block_sector_t sector_idx;
+    struct cache_block *cache_block;
+  };
+
+/* Compares the sectors of the sync_entries at A and B for
+   qsort(). */
+static int
+compare_sync_entries (const void *a_, const void *b_)
+{
+  const struct sync_entry *a = a_;
+  const struct sync_entry *b = b_;
+
+  return a->sector_idx < b->sector_idx ? -1 : a->sector_idx > b->sector_idx;
+}
+
+/* Writes back every block on DIRTY_LIST, in sector order, and
+   empties the list.  A block written back or evicted in the
+   meantime is skipped. */
 void
-cache_shutdown (struct block *fs_device)
+cache_sync (struct block *fs_device, struct list *dirty_list)
+{
+  struct sync_entry entries[CACHE_SIZE];
+  struct list_elem *e;
+  size_t cnt = 0;
+
+  ASSERT (cache_initialized);
+
+  lock_acquire (&dirty_lock);
+  for (e = list_begin (dirty_list); e != list_end (dirty_list);
+       e = list_next (e))
+    {
+      struct cache_block *b = list_entry (e, struct cache_block, dirty_elem);
+      ASSERT (cnt < CACHE_SIZE);
+      entries[cnt].sector_idx = b->sector_index;
+      entries[cnt].cache_block = b;
+      cnt++;
+    }
+  lock_release (&dirty_lock);
+
+  qsort (entries, cnt, sizeof *entries, compare_sync_entries);
+  for (size_t i = 0; i < cnt; i++)
+    {
+      struct cache_block *b = entries[i].cache_block;
+
+      lock_acquire (&b->block_lock);
+      if (b->is_valid && b->sector_index == entries[i].sector_idx)
+        flush_block (fs_device, b);
+      lock_release (&b->block_lock);
+    }
+}
+
+/* Writes the cached copy of SECTOR_IDX to disk now if it is
+   dirty and the journal has not pinned it. */
+void
+cache_write_back (struct block *fs_device, block_sector_t sector_idx)
 {
   lock_acquire (&cache_lock);
+  for (int i = 0; i < CACHE_SIZE; i++)
+    if (cache_blocks[i].is_valid && cache_blocks[i].sector_index == sector_idx)
+      {
+        lock_acquire (&cache_blocks[i].block_lock);
+        flush_block (fs_device, &cache_blocks[i]);
+        lock_release (&cache_blocks[i].block_lock);
+        break;
+      }
+  lock_release (&cache_lock);
+}
+
+/* Empties DIRTY_LIST, whose inode is going away, without writing
+   anything back.  The blocks stay dirty. */
+void
+cache_forget (struct list *dirty_list)
+{
+  lock_acquire (&dirty_lock);
+  while (!list_empty (dirty_list))
+    {
+      struct list_elem *e = list_pop_front (dirty_list);
+      list_entry (e, struct cache_block, dirty_elem)->dirty_list = NULL;
+    }
+  lock_release (&dirty_lock);
+}
+
+/* Flush and invalidate all cache blocks, except those pinned by
+   the journal. */
+static void
+invalidate_all (struct block *fs_device)
+{
+  ASSERT (lock_held_by_current_thread (&cache_lock));
   for (int i = 0; i < CACHE_SIZE; i++)
     {
       flush_block (fs_device, &cache_blocks[i]);
-      cache_blocks[i].is_valid = false;
+      if (!cache_blocks[i].is_pinned)
+        {
+          cache_blocks[i].is_valid = false;
+          cache_blocks[i].is_prefetched = false;
+        }
     }
+}
+
+/* Saves the hottest sectors for warming up the cache at the next
+   boot, then flushes and invalidates the cache. */
+void
+cache_shutdown (struct block *fs_device)
+{
+  lock_acquire (&cache_lock);
+  warmup_stopped = true;
+  save_warmup (fs_device);
+  invalidate_all (fs_device);
   lock_release (&cache_lock);
 }
 
@@ -209,5 +604,159 @@ cache_count (int mode)
 void
 cache_invalidate (struct block *fs_device)
 {
-  cache_shutdown (fs_device);
+  lock_acquire (&cache_lock);
+  invalidate_all (fs_device);
+  lock_release (&cache_lock);
+}
+
+/* Writes an empty warm-up list to a newly formatted file
+   system. */
+void
+cache_warmup_create (struct block *fs_device)
+{
+  static struct warmup_list list;
+
+  ASSERT (sizeof list == BLOCK_SECTOR_SIZE);
+  list.magic = WARMUP_MAGIC;
+  list.cnt = 0;
+  block_write (fs_device, CACHE_WARMUP_SECTOR, &list);
+}
+
+/* Starts prefetching the sectors in the warm-up list saved at the
+   last shutdown, in the background. */
+void
+cache_warmup_start (struct block *fs_device)
+{
+  block_read (fs_device, CACHE_WARMUP_SECTOR, &warmup);
+  if (warmup.magic == WARMUP_MAGIC && warmup.cnt > 0
+      && warmup.cnt <= WARMUP_MAX)
+    thread_create ("cache-warmup", PRI_MIN, warmup_thread, fs_device);
+}
+
+/* Prints warm-up statistics, if any sectors were prefetched. */
+void
+cache_print_stats (void)
+{
+  if (warmup_prefetched > 0)
+    printf ("Cache warm-up: %u sectors prefetched, %u used, "
+            "%u evicted unused, %u%% hit rate\n",
+            warmup_prefetched, warmup_used, warmup_unused,
+            warmup_used * 100 / warmup_prefetched);
+}
+
+/* Prefetches the warm-up list, in sector order, into the free
+   cache blocks.  AUX is the file system device. */
+static void
+warmup_thread (void *fs_device_)
+{
+  struct block *fs_device = fs_device_;
+
+  for (unsigned i = 0; i < warmup.cnt; i++)
+    if (!prefetch_block (fs_device, warmup.sectors[i]))
+      break;
+}
+
+/* Loads SECTOR_IDX into the cache, unless it is there already.
+   Returns false, without loading it, if warming up should stop
+   because the cache is shutting down or has no free block left:
+   evicting live data to prefetch would be a loss. */
+static bool
+prefetch_block (struct block *fs_device, block_sector_t sector_idx)
+{
+  struct cache_block *b;
+  struct list_elem *e;
+
+  lock_acquire (&cache_lock);
+  if (warmup_stopped)
+    {
+      lock_release (&cache_lock);
+      return false;
+    }
+
+  b = lookup_block (sector_idx);
+  if (b != NULL)
+    {
+      lock_release (&b->block_lock);
+      lock_release (&cache_lock);
+      return true;
+    }
+
+  for (e = list_begin (&cache_list); e != list_end (&cache_list);
+       e = list_next (e))
+    {
+      b = list_entry (e, struct cache_block, elem);
+      if (!b->is_pinned)
+        break;
+    }
+  if (e == list_end (&cache_list) || b->is_valid)
+    {
+      lock_release (&cache_lock);
+      return false;
+    }
+
+  b = load_block (fs_device, sector_idx, false);
+  b->is_prefetched = true;
+  warmup_prefetched++;
+  lock_release (&b->block_lock);
+  lock_release (&cache_lock);
+  return true;
+}
+
+/* A candidate for the warm-up list. */
+struct hot_sector
+  {
+    block_sector_t sector_idx;
+    unsigned access_cnt;
+  };
+
+/* Orders hot_sectors for qsort(): most accessed first. */
+static int
+compare_hotness (const void *a_, const void *b_)
+{
+  const struct hot_sector *a = a_;
+  const struct hot_sector *b = b_;
+
+  return a->access_cnt > b->access_cnt ? -1 : a->access_cnt < b->access_cnt;
+}
+
+/* Orders block_sector_ts for qsort(): ascending. */
+static int
+compare_sectors (const void *a_, const void *b_)
+{
+  const block_sector_t *a = a_;
+  const block_sector_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Writes the most accessed sectors in the cache to the warm-up
+   list, if the file system has one.  The caller must hold
+   cache_lock. */
+static void
+save_warmup (struct block *fs_device)
+{
+  static struct warmup_list list;
+  struct hot_sector hot[CACHE_SIZE];
+  size_t cnt = 0;
+
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+
+  block_read (fs_device, CACHE_WARMUP_SECTOR, &list);
+  if (list.magic != WARMUP_MAGIC)
+    return;
+
+  for (int i = 0; i < CACHE_SIZE; i++)
+    if (cache_blocks[i].is_valid && cache_blocks[i].access_cnt > 0)
+      {
+        hot[cnt].sector_idx = cache_blocks[i].sector_index;
+        hot[cnt].access_cnt = cache_blocks[i].access_cnt;
+        cnt++;
+      }
+  qsort (hot, cnt, sizeof *hot, compare_hotness);
+
+  list.cnt = cnt < WARMUP_MAX ? cnt : WARMUP_MAX;
+  for (unsigned i = 0; i < list.cnt; i++)
+    list.sectors[i] = hot[i].sector_idx;
+  qsort (list.sectors, list.cnt, sizeof *list.sectors, compare_sectors);
+  block_write (fs_device, CACHE_WARMUP_SECTOR, &list);
 }
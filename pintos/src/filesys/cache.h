@@ -21,6 +21,11 @@ typedef struct cache_block
     char data[BLOCK_SECTOR_SIZE];
     bool is_valid;
     bool is_dirty;
+    bool is_pinned;             /* Held in cache for the journal. */
+    struct list *dirty_list;    /* Owning inode's dirty blocks, or null. */
+    struct list_elem dirty_elem; /* Element in DIRTY_LIST. */
+    unsigned access_cnt;        /* Accesses since loaded. */
+    bool is_prefetched;         /* Warmed up and not yet accessed? */
     struct list_elem elem; 
     struct lock block_lock;
   } cache_block_t;
@@ -39,18 +44,40 @@ struct lock stat_lock;
 
 void cache_init (void);
 
-void cache_write (struct block *fs_device, block_sector_t sector_idx, void *source, off_t offset, int chunk_size);
+void cache_write (struct block *fs_device, block_sector_t sector_idx, void *source, off_t offset, int chunk_size, struct list *dirty_list);
+
+void cache_write_meta (struct block *fs_device, block_sector_t sector_idx, const void *source, off_t offset, int chunk_size);
 
 void cache_read (struct block *fs_device, block_sector_t sector_idx, void *destination, off_t offset, int chunk_size);
 
+void cache_read_direct (struct block *fs_device, block_sector_t sector_idx, void *destination);
+
+bool cache_write_direct (struct block *fs_device, block_sector_t sector_idx, const void *source);
+
+void cache_discard (block_sector_t sector_idx);
+
+void cache_unpin (block_sector_t sector_idx);
+
 void flush_block (struct block *fs_device, struct cache_block *cache_block);
 
 void cache_flush (struct block *fs_device);
 
+void cache_sync (struct block *fs_device, struct list *dirty_list);
+
+void cache_write_back (struct block *fs_device, block_sector_t sector_idx);
+
+void cache_forget (struct list *dirty_list);
+
 void cache_shutdown (struct block *fs_device);
 
 size_t cache_count (int mode);
 
 void cache_invalidate (struct block *fs_device);
 
+void cache_warmup_create (struct block *fs_device);
+
+void cache_warmup_start (struct block *fs_device);
+
+void cache_print_stats (void);
+
 #endif
@@ -0,0 +1,291 @@
+#include "filesys/dedup.h"
+#include <debug.h>
+#include <hash.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/cache.h"
+#include "filesys/filesys.h"
+#include "filesys/free-map.h"
+#include "filesys/inode.h"
+#include "filesys/journal.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Block-level deduplication of file data.
+
+   With deduplication on, every write to a file's data goes
+   through dedup_write(), which works out the block's new
+   contents and looks them up, by hash, in an index of the
+   blocks written so far.  If another sector already holds the
+   same bytes, the file's block map is pointed at that sector,
+   whose reference count in the free map goes up, and the file's
+   old sector is released.  Otherwise the block is written as
+   usual, except that a sector shared with other files is first
+   copied, so that the write does not show through in them.
+
+   The index lives in memory only, so after a reboot blocks
+   written before are not found again until they are rewritten.
+   The reference counts are on disk, in the free map file, so
+   sharing survives, even a reboot with deduplication off: writes
+   to shared sectors then still go through dedup_write(), which
+   only copies them.  A sector leaves the index when its
+   contents change in place or it is freed.
+
+   Changing block maps needs a journal transaction, so with
+   deduplication on every write to a file runs as one.  Only
+   regular files are deduplicated: directory blocks are
+   metadata. */
+
+/* Most sectors in the index. */
+#define DEDUP_MAX_ENTRIES 4096
+
+/* An indexed sector. */
+struct dedup_entry
+  {
+    struct hash_elem sector_elem;   /* Element in by_sector. */
+    struct hash_elem hash_elem;     /* Element in by_hash. */
+    block_sector_t sector;          /* Sector. */
+    unsigned hash;                  /* Hash of its contents. */
+  };
+
+static bool enabled;
+
+/* Protects everything below. */
+static struct lock dedup_lock;
+
+/* Index of sectors, by sector number and by contents.  Each
+   sector is in both, except that by_hash holds only one sector
+   for any hash value. */
+static struct hash by_sector;
+static struct hash by_hash;
+
+/* Statistics. */
+static unsigned long long shared_cnt;   /* Blocks pointed at a copy. */
+static unsigned long long cow_cnt;      /* Shared blocks copied. */
+
+static hash_hash_func sector_hash, content_hash;
+static hash_less_func sector_less, content_less;
+static struct dedup_entry *find_copy (const void *block, unsigned hash);
+static void add_entry (block_sector_t, unsigned hash);
+static void remove_entry (block_sector_t);
+
+/* Initializes deduplication, which is off until dedup_enable()
+   is called. */
+void
+dedup_init (void)
+{
+  lock_init (&dedup_lock);
+  hash_init (&by_sector, sector_hash, sector_less, NULL);
+  hash_init (&by_hash, content_hash, content_less, NULL);
+}
+
+/* Turns on deduplication, if the free map can count references
+   to shared sectors. */
+void
+dedup_enable (void)
+{
+  if (free_map_has_refcnts ())
+    enabled = true;
+  else
+    printf ("dedup: file system has no reference counts, "
+            "not deduplicating\n");
+}
+
+/* Returns true if writes should go through dedup_write(). */
+bool
+dedup_enabled (void)
+{
+  return enabled;
+}
+
+/* Writes SIZE bytes from BUFFER at offset OFS within data block
+   IDX of INODE, which is in SECTOR, sharing the block with an
+   identical one elsewhere or copying it first if it is shared.
+   A block written in place or copied is added to DIRTY, and a
+   block shared with is written back at once.  Returns false if
+   a copy was needed but the disk is full.  With deduplication
+   off, only does the copying, for a SECTOR shared before.  The
+   caller must hold INODE's lock and run a journal transaction. */
+bool
+dedup_write (struct inode *inode, size_t idx, block_sector_t sector,
+             const void *buffer, off_t ofs, int size, struct list *dirty)
+{
+  static uint8_t block[BLOCK_SECTOR_SIZE];
+  struct dedup_entry *copy;
+  bool shared;
+  unsigned hash;
+
+  ASSERT (ofs + size <= BLOCK_SECTOR_SIZE);
+
+  lock_acquire (&dedup_lock);
+  if (ofs != 0 || size != BLOCK_SECTOR_SIZE)
+    cache_read (fs_device, sector, block, 0, BLOCK_SECTOR_SIZE);
+  memcpy (block + ofs, buffer, size);
+  hash = hash_bytes (block, BLOCK_SECTOR_SIZE);
+
+  /* Other owners still see the old contents of a shared
+     sector, so it stays in the index. */
+  shared = free_map_shared (sector);
+  if (!shared)
+    remove_entry (sector);
+
+  copy = enabled ? find_copy (block, hash) : NULL;
+  if (copy != NULL && copy->sector == sector)
+    {
+      /* Unchanged contents of a shared sector. */
+      lock_release (&dedup_lock);
+      return true;
+    }
+  if (copy != NULL && free_map_share (copy->sector))
+    {
+      /* The copy may be dirty on another inode's list, which a
+         sync of INODE would not write, so write it now, before
+         INODE points to it. */
+      cache_write_back (fs_device, copy->sector);
+      inode_set_block (inode, idx, copy->sector);
+      free_map_release (sector, 1);
+      shared_cnt++;
+      lock_release (&dedup_lock);
+      return true;
+    }
+
+  if (shared)
+    {
+      block_sector_t new_sector;
+
+      if (!free_map_allocate (1, &new_sector))
+        {
+          lock_release (&dedup_lock);
+          return false;
+        }
+      journal_revoke (new_sector);
+      inode_set_block (inode, idx, new_sector);
+      free_map_release (sector, 1);
+      sector = new_sector;
+      cow_cnt++;
+    }
+
+  cache_write (fs_device, sector, block, 0, BLOCK_SECTOR_SIZE, dirty);
+  if (enabled)
+    add_entry (sector, hash);
+  lock_release (&dedup_lock);
+  return true;
+}
+
+/* Removes SECTOR, which has been freed, from the index. */
+void
+dedup_forget (block_sector_t sector)
+{
+  bool held = lock_held_by_current_thread (&dedup_lock);
+
+  if (!enabled)
+    return;
+  if (!held)
+    lock_acquire (&dedup_lock);
+  remove_entry (sector);
+  if (!held)
+    lock_release (&dedup_lock);
+}
+
+/* Prints deduplication statistics, if it is on. */
+void
+dedup_print_stats (void)
+{
+  if (enabled)
+    printf ("Dedup: %llu blocks shared, %llu copied on write, "
+            "%zu sectors indexed\n",
+            shared_cnt, cow_cnt, hash_size (&by_sector));
+}
+
+/* Returns the index entry for a sector that holds the same
+   contents as BLOCK, whose hash is HASH, or a null pointer if
+   there is none. */
+static struct dedup_entry *
+find_copy (const void *block, unsigned hash)
+{
+  static uint8_t other[BLOCK_SECTOR_SIZE];
+  struct dedup_entry key;
+  struct hash_elem *e;
+  struct dedup_entry *copy;
+
+  key.hash = hash;
+  e = hash_find (&by_hash, &key.hash_elem);
+  if (e == NULL)
+    return NULL;
+  copy = hash_entry (e, struct dedup_entry, hash_elem);
+
+  /* Hashes collide, so compare the contents. */
+  cache_read (fs_device, copy->sector, other, 0, BLOCK_SECTOR_SIZE);
+  return memcmp (block, other, BLOCK_SECTOR_SIZE) ? NULL : copy;
+}
+
+/* Adds SECTOR, whose contents have hash HASH, to the index,
+   unless it is full. */
+static void
+add_entry (block_sector_t sector, unsigned hash)
+{
+  struct dedup_entry *e;
+
+  if (hash_size (&by_sector) >= DEDUP_MAX_ENTRIES)
+    return;
+  e = malloc (sizeof *e);
+  if (e == NULL)
+    return;
+  e->sector = sector;
+  e->hash = hash;
+  if (hash_insert (&by_sector, &e->sector_elem) != NULL)
+    {
+      free (e);
+      return;
+    }
+  hash_insert (&by_hash, &e->hash_elem);
+}
+
+/* Removes SECTOR from the index, if it is there. */
+static void
+remove_entry (block_sector_t sector)
+{
+  struct dedup_entry key;
+  struct hash_elem *e;
+  struct dedup_entry *entry;
+
+  key.sector = sector;
+  e = hash_delete (&by_sector, &key.sector_elem);
+  if (e == NULL)
+    return;
+  entry = hash_entry (e, struct dedup_entry, sector_elem);
+
+  /* by_hash holds only the first sector with each hash. */
+  e = hash_find (&by_hash, &entry->hash_elem);
+  if (e != NULL && hash_entry (e, struct dedup_entry, hash_elem) == entry)
+    hash_delete (&by_hash, &entry->hash_elem);
+  free (entry);
+}
+
+static unsigned
+sector_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct dedup_entry, sector_elem)->sector);
+}
+
+static bool
+sector_less (const struct hash_elem *a, const struct hash_elem *b,
+             void *aux UNUSED)
+{
+  return (hash_entry (a, struct dedup_entry, sector_elem)->sector
+          < hash_entry (b, struct dedup_entry, sector_elem)->sector);
+}
+
+static unsigned
+content_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_entry (e, struct dedup_entry, hash_elem)->hash;
+}
+
+static bool
+content_less (const struct hash_elem *a, const struct hash_elem *b,
+              void *aux UNUSED)
+{
+  return (hash_entry (a, struct dedup_entry, hash_elem)->hash
+          < hash_entry (b, struct dedup_entry, hash_elem)->hash);
+}
@@ -0,0 +1,19 @@
+#ifndef FILESYS_DEDUP_H
+#define FILESYS_DEDUP_H
+
+#include <list.h>
+#include <stdbool.h>
+#include "devices/block.h"
+#include "filesys/off_t.h"
+
+struct inode;
+
+void dedup_init (void);
+void dedup_enable (void);
+bool dedup_enabled (void);
+bool dedup_write (struct inode *, size_t idx, block_sector_t,
+                  const void *, off_t ofs, int size, struct list *dirty);
+void dedup_forget (block_sector_t);
+void dedup_print_stats (void);
+
+#endif /* filesys/dedup.h */
@@ -0,0 +1,321 @@
+#include "filesys/defrag.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "filesys/cache.h"
+#include "filesys/directory.h"
+#include "filesys/filesys.h"
+#include "filesys/free-map.h"
+#include "filesys/inode.h"
+#include "filesys/journal.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Online defragmenter.
+
+   A pass walks the directory tree from the root and, for each
+   regular file whose data blocks are not in one contiguous run,
+   moves them into contiguous free space DEFRAG_WINDOW blocks at
+   a time, placing each window right after the previous one when
+   there is room.  Moving a window
+
+     - copies its blocks to a newly allocated run and writes the
+       copies to disk,
+     - points the file's block map at the copies and frees the
+       old blocks, and
+     - commits the journal,
+
+   all in one journal transaction and under the inode's lock.
+   So the file never points at blocks that do not hold its data,
+   even after a crash, and nothing can reuse the old blocks before
+   the new pointers are durable.
+
+   Directories are left alone: their blocks are metadata, which
+   the journal would have to log in full to move.
+
+   defrag_run() runs a pass on demand.  defrag_start() also runs
+   one every few seconds in a background thread, which yields
+   after every window so that it only uses otherwise idle time. */
+
+/* Most blocks moved at once. */
+#define DEFRAG_WINDOW 32
+
+/* Held during a pass.  Also protects everything below. */
+static struct lock defrag_lock;
+static bool stopped;
+
+/* Statistics. */
+static unsigned long long pass_cnt;        /* Passes run. */
+static unsigned long long file_cnt;        /* Files examined. */
+static unsigned long long fragmented_cnt;  /* ...that were fragmented. */
+static unsigned long long extents_before;  /* Their extents before... */
+static unsigned long long extents_after;   /* ...and after. */
+static unsigned long long moved_cnt;       /* Blocks moved. */
+
+/* A directory waiting to be walked. */
+struct pending_dir
+  {
+    struct list_elem elem;
+    block_sector_t sector;      /* Inode sector. */
+  };
+
+static thread_func defrag_thread;
+static size_t defrag_file (struct inode *);
+static size_t move_window (struct inode *, size_t first, size_t cnt,
+                           block_sector_t *hint);
+static size_t count_extents (struct inode *);
+static bool push_dir (struct list *, block_sector_t);
+
+/* Initializes the defragmenter. */
+void
+defrag_init (void)
+{
+  lock_init (&defrag_lock);
+}
+
+/* Starts a background thread that runs a pass every INTERVAL
+   seconds. */
+void
+defrag_start (int interval)
+{
+  static int interval_ticks;
+
+  ASSERT (interval > 0);
+  interval_ticks = interval * TIMER_FREQ;
+  thread_create ("defrag", PRI_MIN, defrag_thread, &interval_ticks);
+}
+
+/* Stops the defragmenter, waiting for a running pass to end. */
+void
+defrag_done (void)
+{
+  lock_acquire (&defrag_lock);
+  stopped = true;
+  lock_release (&defrag_lock);
+}
+
+/* Runs one pass over every file in the file system and returns
+   the number of blocks moved. */
+size_t
+defrag_run (void)
+{
+  struct list dirs;
+  size_t moved = 0;
+
+  lock_acquire (&defrag_lock);
+  if (stopped)
+    {
+      lock_release (&defrag_lock);
+      return 0;
+    }
+
+  list_init (&dirs);
+  push_dir (&dirs, ROOT_DIR_SECTOR);
+  while (!list_empty (&dirs))
+    {
+      struct pending_dir *p = list_entry (list_pop_front (&dirs),
+                                          struct pending_dir, elem);
+      struct dir *dir = dir_open (inode_open (p->sector));
+      char name[NAME_MAX + 1];
+
+      free (p);
+      if (dir == NULL)
+        continue;
+      while (dir_readdir (dir, name))
+        {
+          struct inode *inode;
+
+          if (!dir_lookup (dir, name, &inode))
+            continue;
+          if (inode_isdir (inode))
+            push_dir (&dirs, inode_get_inumber (inode));
+          else
+            moved += defrag_file (inode);
+          inode_close (inode);
+        }
+      dir_close (dir);
+    }
+
+  pass_cnt++;
+  moved_cnt += moved;
+  lock_release (&defrag_lock);
+  return moved;
+}
+
+/* Prints defragmenter statistics, if it has run. */
+void
+defrag_print_stats (void)
+{
+  if (pass_cnt > 0)
+    printf ("Defrag: %llu passes, %llu files, %llu fragmented, "
+            "%llu extents before, %llu after, %llu blocks moved\n",
+            pass_cnt, file_cnt, fragmented_cnt, extents_before,
+            extents_after, moved_cnt);
+}
+
+/* Background thread.  AUX points to the ticks between passes. */
+static void
+defrag_thread (void *interval_ticks_)
+{
+  const int *interval_ticks = interval_ticks_;
+
+  while (!stopped)
+    {
+      timer_sleep (*interval_ticks);
+      defrag_run ();
+    }
+}
+
+/* Makes the data blocks of INODE, a regular file, contiguous as
+   far as free space allows.  Returns the number of blocks
+   moved. */
+static size_t
+defrag_file (struct inode *inode)
+{
+  struct lock *lock = inode_lock (inode);
+  block_sector_t hint = 0;
+  size_t extents, first, cnt;
+  size_t moved = 0;
+
+  lock_acquire (lock);
+  extents = count_extents (inode);
+  lock_release (lock);
+
+  file_cnt++;
+  if (extents <= 1)
+    return 0;
+  fragmented_cnt++;
+  extents_before += extents;
+
+  for (first = 0; ; first += DEFRAG_WINDOW)
+    {
+      size_t window_moved;
+
+      journal_begin ();
+      lock_acquire (lock);
+      cnt = inode_block_cnt (inode);
+      if (first >= cnt || inode_get_removed (inode))
+        {
+          lock_release (lock);
+          journal_end ();
+          break;
+        }
+
+      window_moved = move_window (inode, first,
+                                  cnt - first < DEFRAG_WINDOW
+                                  ? cnt - first : DEFRAG_WINDOW,
+                                  &hint);
+      if (window_moved > 0)
+        journal_commit ();
+      lock_release (lock);
+      journal_end ();
+
+      moved += window_moved;
+      thread_yield ();
+    }
+
+  lock_acquire (lock);
+  extents_after += count_extents (inode);
+  lock_release (lock);
+  return moved;
+}
+
+/* Moves the CNT data blocks of INODE starting at block FIRST to
+   a contiguous run of free sectors, preferably at *HINT, unless
+   they already are contiguous or some are shared with other
+   files, which moving would unshare.  Sets *HINT to the sector just
+   past the window's blocks.  Returns the number of blocks moved.
+   The caller must hold INODE's lock and run a transaction. */
+static size_t
+move_window (struct inode *inode, size_t first, size_t cnt,
+             block_sector_t *hint)
+{
+  static char buf[BLOCK_SECTOR_SIZE];
+  block_sector_t old[DEFRAG_WINDOW];
+  block_sector_t start;
+  struct list dirty;
+  bool contiguous = true;
+  bool shared = false;
+  size_t i;
+
+  ASSERT (cnt > 0 && cnt <= DEFRAG_WINDOW);
+
+  for (i = 0; i < cnt; i++)
+    {
+      old[i] = inode_get_block (inode, first + i);
+      if (i > 0 && old[i] != old[i - 1] + 1)
+        contiguous = false;
+      if (free_map_shared (old[i]))
+        shared = true;
+    }
+  if (contiguous || shared)
+    {
+      *hint = old[cnt - 1] + 1;
+      return 0;
+    }
+
+  /* Commit first, so that none of the sectors allocated below
+     is still pinned as metadata freed in the running
+     transaction. */
+  journal_commit ();
+  if (!free_map_allocate_near (cnt, *hint, &start))
+    {
+      *hint = old[cnt - 1] + 1;
+      return 0;
+    }
+
+  /* Write the copies home before anything points to them.  No
+     block may keep pointing to DIRTY after we return. */
+  list_init (&dirty);
+  for (i = 0; i < cnt; i++)
+    {
+      journal_revoke (start + i);
+      cache_read (fs_device, old[i], buf, 0, BLOCK_SECTOR_SIZE);
+      cache_write (fs_device, start + i, buf, 0, BLOCK_SECTOR_SIZE, &dirty);
+    }
+  cache_sync (fs_device, &dirty);
+  cache_forget (&dirty);
+
+  for (i = 0; i < cnt; i++)
+    {
+      inode_set_block (inode, first + i, start + i);
+      free_map_release (old[i], 1);
+    }
+  *hint = start + cnt;
+  return cnt;
+}
+
+/* Returns the number of runs of consecutive sectors that hold
+   INODE's data.  The caller must hold INODE's lock. */
+static size_t
+count_extents (struct inode *inode)
+{
+  size_t cnt = inode_block_cnt (inode);
+  size_t extents = 0;
+  block_sector_t prev = 0;
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      block_sector_t sector = inode_get_block (inode, i);
+      if (i == 0 || sector != prev + 1)
+        extents++;
+      prev = sector;
+    }
+  return extents;
+}
+
+/* Adds the directory whose inode is at SECTOR to DIRS.  Returns
+   false if out of memory. */
+static bool
+push_dir (struct list *dirs, block_sector_t sector)
+{
+  struct pending_dir *p = malloc (sizeof *p);
+  if (p == NULL)
+    return false;
+  p->sector = sector;
+  list_push_back (dirs, &p->elem);
+  return true;
+}
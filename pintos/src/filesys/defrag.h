@@ -0,0 +1,12 @@
+#ifndef FILESYS_DEFRAG_H
+#define FILESYS_DEFRAG_H
+
+#include <stddef.h>
+
+void defrag_init (void);
+void defrag_start (int interval);
+void defrag_done (void);
+size_t defrag_run (void);
+void defrag_print_stats (void);
+
+#endif /* filesys/defrag.h */
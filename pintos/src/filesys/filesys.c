@@ -7,6 +7,9 @@
 #include "filesys/inode.h"
 #include "filesys/directory.h"
 #include "filesys/cache.h"
+#include "filesys/dedup.h"
+#include "filesys/defrag.h"
+#include "filesys/journal.h"
 
 /* Partition that contains the file system. */
 struct block *fs_device;
@@ -29,7 +32,11 @@ filesys_init (bool format)
   if (format)
     do_format ();
 
+  journal_open ();
   free_map_open ();
+  dedup_init ();
+  defrag_init ();
+  cache_warmup_start (fs_device);
 }
 
 /* Shuts down the file system module, writing any unwritten data
@@ -37,6 +44,8 @@ filesys_init (bool format)
 void
 filesys_done (void)
 {
+  defrag_done ();
+  journal_done ();
   free_map_close ();
   cache_shutdown (fs_device);
 }
@@ -53,6 +62,7 @@ filesys_create (const char *name, off_t initial_size, bool is_dir)
   struct dir *dir;
   bool success;
 
+  journal_begin ();
   if (is_dir)
   {
     success = (split_path_dir (name, last, &dir)
@@ -75,6 +85,7 @@ filesys_create (const char *name, off_t initial_size, bool is_dir)
   if (!success && inode_sector != 0)
     free_map_release (inode_sector, 1);
   dir_close (dir);
+  journal_end ();
 
   return success;
 }
@@ -119,10 +130,12 @@ filesys_remove (const char *name)
 {
   struct dir *directory;
   char last[NAME_MAX + 1];
+  journal_begin ();
   split_path_dir (name, last, &directory);
  
   bool success = directory != NULL && dir_remove (directory, last);
   dir_close (directory);
+  journal_end ();
 
   return success;
 }
@@ -135,6 +148,8 @@ do_format (void)
   free_map_create ();
   if (!dir_create (ROOT_DIR_SECTOR, 16))
     PANIC ("root directory creation failed");
+  journal_create ();
+  cache_warmup_create (fs_device);
   free_map_close ();
   printf ("done.\n");
 }
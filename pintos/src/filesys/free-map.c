@@ -1,13 +1,27 @@
 #include "filesys/free-map.h"
 #include <bitmap.h>
 #include <debug.h>
+#include <stdint.h>
+#include "filesys/cache.h"
+#include "filesys/dedup.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
+#include "threads/malloc.h"
 
 static struct file *free_map_file;   /* Free map file. */
 static struct bitmap *free_map;      /* Free map, one bit per sector. */
 
+/* Reference counts, one byte per sector, stored in the free map
+   file after the bitmap.  A sector's count is the number of
+   references to it beyond the first, so that 0 means that it is
+   free or has one owner.  Null if the free map file predates
+   reference counts, in which case no sector can be shared. */
+static uint8_t *refcnts;
+static size_t shared_cnt;            /* Sectors with counts above 0. */
+
+static void write_refcnt (block_sector_t);
+
 /* Initializes the free map. */
 void
 free_map_init (void)
@@ -17,6 +31,8 @@ free_map_init (void)
     PANIC ("bitmap creation failed--file system device is too large");
   bitmap_mark (free_map, FREE_MAP_SECTOR);
   bitmap_mark (free_map, ROOT_DIR_SECTOR);
+  bitmap_mark (free_map, JOURNAL_SECTOR);
+  bitmap_mark (free_map, CACHE_WARMUP_SECTOR);
 }
 
 /* Allocates CNT consecutive sectors from the free map and stores
@@ -27,7 +43,18 @@ free_map_init (void)
 bool
 free_map_allocate (size_t cnt, block_sector_t *sectorp)
 {
-  block_sector_t sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
+  return free_map_allocate_near (cnt, 0, sectorp);
+}
+
+/* Like free_map_allocate(), but takes the first run of CNT free
+   sectors at or after HINT, if there is one. */
+bool
+free_map_allocate_near (size_t cnt, block_sector_t hint,
+                        block_sector_t *sectorp)
+{
+  block_sector_t sector = bitmap_scan_and_flip (free_map, hint, cnt, false);
+  if (sector == BITMAP_ERROR && hint != 0)
+    sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
   if (sector != BITMAP_ERROR
       && free_map_file != NULL
       && !bitmap_write (free_map, free_map_file))
@@ -40,15 +67,81 @@ free_map_allocate (size_t cnt, block_sector_t *sectorp)
   return sector != BITMAP_ERROR;
 }
 
-/* Makes CNT sectors starting at SECTOR available for use. */
+/* Drops a reference to each of the CNT sectors starting at
+   SECTOR, making those that have no references left available
+   for use.  Their cached blocks are discarded, so that stale
+   dirty contents are neither written over the sector's next use
+   nor left on the old owner's list of dirty blocks. */
 void
 free_map_release (block_sector_t sector, size_t cnt)
 {
+  size_t i;
+
   ASSERT (bitmap_all (free_map, sector, cnt));
-  bitmap_set_multiple (free_map, sector, cnt, false);
+  for (i = 0; i < cnt; i++)
+    if (refcnts != NULL && refcnts[sector + i] > 0)
+      {
+        if (--refcnts[sector + i] == 0)
+          shared_cnt--;
+        write_refcnt (sector + i);
+      }
+    else
+      {
+        bitmap_reset (free_map, sector + i);
+        dedup_forget (sector + i);
+        cache_discard (sector + i);
+      }
   bitmap_write (free_map, free_map_file);
 }
 
+/* Adds a reference to allocated SECTOR, so that it takes one
+   more free_map_release() to free it.  Returns false if the free
+   map cannot count any more references to SECTOR. */
+bool
+free_map_share (block_sector_t sector)
+{
+  ASSERT (bitmap_test (free_map, sector));
+  if (refcnts == NULL || refcnts[sector] == UINT8_MAX)
+    return false;
+  if (refcnts[sector]++ == 0)
+    shared_cnt++;
+  write_refcnt (sector);
+  return true;
+}
+
+/* Returns true if allocated SECTOR has more than one
+   reference. */
+bool
+free_map_shared (block_sector_t sector)
+{
+  return refcnts != NULL && refcnts[sector] > 0;
+}
+
+/* Returns true if any sector has more than one reference.
+   Sharing outlives deduplication, which may since have been
+   turned off, so writes must still copy shared sectors. */
+bool
+free_map_any_shared (void)
+{
+  return shared_cnt > 0;
+}
+
+/* Returns true if the free map keeps reference counts, so that
+   sectors can be shared. */
+bool
+free_map_has_refcnts (void)
+{
+  return refcnts != NULL;
+}
+
+/* Writes SECTOR's reference count to the free map file. */
+static void
+write_refcnt (block_sector_t sector)
+{
+  file_write_at (free_map_file, &refcnts[sector], 1,
+                 bitmap_file_size (free_map) + sector);
+}
+
 /* Opens the free map file and reads it from disk. */
 void
 free_map_open (void)
@@ -58,6 +151,24 @@ free_map_open (void)
     PANIC ("can't open free map");
   if (!bitmap_read (free_map, free_map_file))
     PANIC ("can't read free map");
+
+  /* Read the reference counts, if the file has them. */
+  size_t sector_cnt = block_size (fs_device);
+  off_t refcnt_ofs = bitmap_file_size (free_map);
+  if (file_length (free_map_file) >= refcnt_ofs + (off_t) sector_cnt)
+    {
+      size_t i;
+
+      refcnts = malloc (sector_cnt);
+      if (refcnts == NULL)
+        PANIC ("can't allocate reference counts");
+      if (file_read_at (free_map_file, refcnts, sector_cnt, refcnt_ofs)
+          != (off_t) sector_cnt)
+        PANIC ("can't read reference counts");
+      for (i = 0; i < sector_cnt; i++)
+        if (refcnts[i] > 0)
+          shared_cnt++;
+    }
 }
 
 /* Writes the free map to disk and closes the free map file. */
@@ -68,12 +179,15 @@ free_map_close (void)
 }
 
 /* Creates a new free map file on disk and writes the free map to
-   it. */
+   it.  The reference counts that follow the bitmap start out
+   zeroed. */
 void
 free_map_create (void)
 {
   /* Create inode. */
-  if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map), false))
+  if (!inode_create (FREE_MAP_SECTOR,
+                     bitmap_file_size (free_map) + block_size (fs_device),
+                     false))
     PANIC ("free map creation failed");
 
   /* Write bitmap to file. */
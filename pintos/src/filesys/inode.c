@@ -1,11 +1,14 @@
 #include "filesys/inode.h"
 #include "filesys/cache.h"
+#include "filesys/dedup.h"
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "filesys/journal.h"
 #include "threads/malloc.h"
 #include <debug.h>
 #include <list.h>
 #include <round.h>
+#include <stddef.h>
 #include <string.h>
 
 /* Identifies an inode. */
@@ -39,7 +42,11 @@ struct inode
     int open_cnt;          /* Number of openers. */
     bool removed;          /* True if deleted, false otherwise. */
     int deny_write_cnt;    /* 0: writes ok, >0: deny writes. */
+    unsigned write_gen;    /* Incremented on every write. */
     struct lock f_lock;    /* Synchronization between users of inode. */
+    struct list dirty_blocks; /* Dirty data blocks in the buffer cache. */
+    bool meta_dirty;       /* Grown or remapped since the last
+                              inode_sync()? */
   };
 
 struct inode_disk *
@@ -126,9 +133,9 @@ inode_create (block_sector_t sector, off_t length, bool is_directory)
       disk_inode->is_dir = is_directory;
       disk_inode->magic = INODE_MAGIC;
 
-      if (disk_allocate (disk_inode, length))
+      if (disk_allocate (disk_inode, length, NULL))
         {
-          cache_write (fs_device, sector, disk_inode, 0, BLOCK_SECTOR_SIZE);
+          cache_write_meta (fs_device, sector, disk_inode, 0, BLOCK_SECTOR_SIZE);
           success = true;
         }
       free (disk_inode);
@@ -136,27 +143,40 @@ inode_create (block_sector_t sector, off_t length, bool is_directory)
   return success;
 }
 
+/* Allocates and zeroes a sector, storing its number in
+   *SECTOR_IDX.  META says whether it will hold metadata, which
+   the journal must log, or file data, which it must not replay
+   anything over.  A data block is added to DIRTY, if non-null. */
 static bool
-sector_allocate (block_sector_t *sector_idx)
+sector_allocate (block_sector_t *sector_idx, bool meta, struct list *dirty)
 {
   static char buffer[BLOCK_SECTOR_SIZE];
   if (!free_map_allocate (1, sector_idx))
     return false;
 
-  cache_write (fs_device, *sector_idx, buffer, 0, BLOCK_SECTOR_SIZE);
+  if (meta)
+    cache_write_meta (fs_device, *sector_idx, buffer, 0, BLOCK_SECTOR_SIZE);
+  else
+    {
+      journal_revoke (*sector_idx);
+      cache_write (fs_device, *sector_idx, buffer, 0, BLOCK_SECTOR_SIZE,
+                   dirty);
+    }
   return true;
 }
 
 bool
-indirect_allocate (block_sector_t sector_idx, size_t number_of_sectors)
+indirect_allocate (block_sector_t sector_idx, size_t number_of_sectors, bool meta,
+                   struct list *dirty)
 {
   block_sector_t indirect_blocks[INDIRECT_BLOCK];
   cache_read (fs_device, sector_idx, &indirect_blocks, 0, BLOCK_SECTOR_SIZE);
   for (size_t i = 0; i < MIN (INDIRECT_BLOCK, number_of_sectors); i++)
-    if (indirect_blocks[i] == 0 && !sector_allocate (&indirect_blocks[i]))
+    if (indirect_blocks[i] == 0
+        && !sector_allocate (&indirect_blocks[i], meta, dirty))
       return false;
 
-  cache_write (fs_device, sector_idx, &indirect_blocks, 0, BLOCK_SECTOR_SIZE);
+  cache_write_meta (fs_device, sector_idx, &indirect_blocks, 0, BLOCK_SECTOR_SIZE);
   return true;
 }
 
@@ -173,7 +193,8 @@ indirect_deallocate (block_sector_t sector_num, size_t number_of_sectors)
 }
 
 static size_t
-dbindirect_allocate (struct inode_disk *disk_inode, size_t number_of_sectors)
+dbindirect_allocate (struct inode_disk *disk_inode, size_t number_of_sectors,
+                     struct list *dirty)
 {
   block_sector_t double_blocks[INDIRECT_BLOCK];
   cache_read (fs_device, disk_inode->double_indirect, &double_blocks, 0, BLOCK_SECTOR_SIZE);
@@ -186,36 +207,44 @@ dbindirect_allocate (struct inode_disk *disk_inode, size_t number_of_sectors)
         chunk = number_of_sectors;
       else
         chunk = INDIRECT_BLOCK;
-      if (double_blocks[i] == 0 && !sector_allocate (&double_blocks[i]))
+      if (double_blocks[i] == 0
+          && !sector_allocate (&double_blocks[i], true, NULL))
         return false;
-      if (!indirect_allocate (double_blocks[i], chunk))
+      if (!indirect_allocate (double_blocks[i], chunk, disk_inode->is_dir,
+                              dirty))
         return false;
       number_of_sectors -= chunk;
     }
 
-  cache_write (fs_device, disk_inode->double_indirect, &double_blocks, 0, BLOCK_SECTOR_SIZE);
+  cache_write_meta (fs_device, disk_inode->double_indirect, &double_blocks, 0, BLOCK_SECTOR_SIZE);
   return number_of_sectors;
 }
 
+/* Allocates the sectors DISK_INODE needs to hold LENGTH bytes.
+   New data blocks are added to DIRTY, if non-null. */
 static bool
-disk_allocate (struct inode_disk *disk_inode, off_t length)
+disk_allocate (struct inode_disk *disk_inode, off_t length, struct list *dirty)
 {
   if (length < 0)
     return false;
   size_t number_of_sectors = DIV_ROUND_UP (length, BLOCK_SECTOR_SIZE);
   size_t i;
   for (i = 0; i < MIN (DIRECT_BLOCK, number_of_sectors); i++)
-    if (!disk_inode->direct[i] && !sector_allocate (&disk_inode->direct[i]))
+    if (!disk_inode->direct[i]
+        && !sector_allocate (&disk_inode->direct[i], disk_inode->is_dir,
+                             dirty))
       return false;
 
   number_of_sectors -= i;
   if (number_of_sectors == 0)
     return true;
 
-  if (!disk_inode->indirect && !sector_allocate (&disk_inode->indirect))
+  if (!disk_inode->indirect
+      && !sector_allocate (&disk_inode->indirect, true, NULL))
     return false;
 
-  if (!indirect_allocate (disk_inode->indirect, number_of_sectors))
+  if (!indirect_allocate (disk_inode->indirect, number_of_sectors,
+                          disk_inode->is_dir, dirty))
     return false;
   if (number_of_sectors > INDIRECT_BLOCK)
     number_of_sectors -= INDIRECT_BLOCK;
@@ -225,10 +254,12 @@ disk_allocate (struct inode_disk *disk_inode, off_t length)
   if (number_of_sectors > INDIRECT_BLOCK * INDIRECT_BLOCK)
     number_of_sectors = INDIRECT_BLOCK * INDIRECT_BLOCK;
 
-  if (disk_inode->double_indirect == 0 && !sector_allocate (&disk_inode->double_indirect))
+  if (disk_inode->double_indirect == 0
+      && !sector_allocate (&disk_inode->double_indirect, true, NULL))
     return false;
 
-  number_of_sectors = dbindirect_allocate (disk_inode, number_of_sectors);
+  number_of_sectors = dbindirect_allocate (disk_inode, number_of_sectors,
+                                           dirty);
 
   if (number_of_sectors <= INDIRECT_BLOCK * INDIRECT_BLOCK)
     return true;
@@ -343,7 +374,10 @@ inode_open (block_sector_t sector)
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  inode->write_gen = 0;
   lock_init (&inode->f_lock);
+  list_init (&inode->dirty_blocks);
+  inode->meta_dirty = false;
   return inode;
 }
 
@@ -363,6 +397,15 @@ inode_get_inumber (const struct inode *inode)
   return inode->sector;
 }
 
+/* Returns INODE's write generation, which changes whenever its
+   data is written.  Lets caches of file contents detect that
+   they are stale for as long as they keep INODE open. */
+unsigned
+inode_write_gen (const struct inode *inode)
+{
+  return inode->write_gen;
+}
+
 /* Returns INODE's remove status. */
 bool
 inode_get_removed (const struct inode *inode)
@@ -403,17 +446,95 @@ inode_close (struct inode *inode)
     {
       /* Remove from inode list and release lock. */
       list_remove (&inode->elem);
+      cache_forget (&inode->dirty_blocks);
 
       if (inode->removed)
         {
+          journal_begin ();
           free_map_release (inode->sector, 1);
           disk_deallocate (inode);
+          journal_end ();
         }
 
       free (inode);
     }
 }
 
+/* Writes INODE's dirty data blocks to disk, in sector order,
+   and then its metadata, so that they survive a crash.  With
+   DATA_ONLY, skips the metadata unless INODE has grown or had a
+   data block moved since it was last synced, as fdatasync()
+   does.  A directory's contents
+   are metadata, so they are always written.  Metadata is made
+   durable by committing the journal, if there is one, before
+   the inode itself is written. */
+void
+inode_sync (struct inode *inode, bool data_only)
+{
+  bool write_meta;
+
+  lock_acquire (&inode->f_lock);
+  cache_sync (fs_device, &inode->dirty_blocks);
+  write_meta = !data_only || inode->meta_dirty || inode_isdir (inode);
+  inode->meta_dirty = false;
+  lock_release (&inode->f_lock);
+
+  if (write_meta)
+    {
+      journal_commit ();
+      cache_write_back (fs_device, inode->sector);
+    }
+}
+
+/* Returns the number of data blocks in INODE. */
+size_t
+inode_block_cnt (const struct inode *inode)
+{
+  return DIV_ROUND_UP (inode_length (inode), BLOCK_SECTOR_SIZE);
+}
+
+/* Returns the sector that holds data block IDX of INODE, which
+   must be less than inode_block_cnt(INODE). */
+block_sector_t
+inode_get_block (const struct inode *inode, size_t idx)
+{
+  return byte_to_sector (inode, idx * BLOCK_SECTOR_SIZE);
+}
+
+/* Points data block IDX of INODE, which must exist, at SECTOR.
+   The caller must hold INODE's lock, and should run a journal
+   transaction. */
+void
+inode_set_block (struct inode *inode, size_t idx, block_sector_t sector)
+{
+  struct inode_disk *id = read_inode (inode);
+  block_sector_t map_sector;
+
+  ASSERT (idx < (size_t) DIV_ROUND_UP (id->length, BLOCK_SECTOR_SIZE));
+
+  if (idx < DIRECT_BLOCK)
+    {
+      map_sector = inode->sector;
+      idx += offsetof (struct inode_disk, direct) / sizeof (block_sector_t);
+    }
+  else if ((idx -= DIRECT_BLOCK) < INDIRECT_BLOCK)
+    map_sector = id->indirect;
+  else
+    {
+      block_sector_t blocks[INDIRECT_BLOCK];
+
+      idx -= INDIRECT_BLOCK;
+      cache_read (fs_device, id->double_indirect, &blocks, 0, BLOCK_SECTOR_SIZE);
+      map_sector = blocks[idx / INDIRECT_BLOCK];
+      idx %= INDIRECT_BLOCK;
+    }
+  free (id);
+
+  cache_write_meta (fs_device, map_sector, &sector,
+                    idx * sizeof (block_sector_t), sizeof sector);
+  inode->meta_dirty = true;
+}
+
 /* Marks INODE to be deleted when it is closed by the last caller who
    has it open. */
 void
@@ -423,11 +544,36 @@ inode_remove (struct inode *inode)
   inode->removed = true;
 }
 
+static off_t read_at (struct inode *, void *, off_t, off_t, bool direct);
+static off_t write_at (struct inode *, const void *, off_t, off_t,
+                       bool direct);
+
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
    Returns the number of bytes actually read, which may be less
    than SIZE if an error occurs or end of file is reached. */
 off_t
-inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
+inode_read_at (struct inode *inode, void *buffer, off_t size, off_t offset)
+{
+  return read_at (inode, buffer, size, offset, false);
+}
+
+/* Like inode_read_at(), but reads whole sectors straight from
+   the disk into BUFFER instead of through the buffer cache,
+   which keeps a large streaming read from evicting everything
+   else.  Sectors that are already cached are copied from the
+   cache. */
+off_t
+inode_read_at_direct (struct inode *inode, void *buffer, off_t size,
+                      off_t offset)
+{
+  return read_at (inode, buffer, size, offset, true);
+}
+
+/* Reads SIZE bytes from INODE into BUFFER, starting at OFFSET,
+   bypassing the cache for whole sectors if DIRECT. */
+static off_t
+read_at (struct inode *inode, void *buffer_, off_t size, off_t offset,
+         bool direct)
 {
   uint8_t *buffer = buffer_;
   off_t bytes_read = 0;
@@ -450,7 +596,10 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       if (chunk_size <= 0)
         break;
 
-      cache_read (fs_device, sector_idx, (void *) (buffer + bytes_read), sector_ofs, chunk_size);
+      if (direct && chunk_size == BLOCK_SECTOR_SIZE)
+        cache_read_direct (fs_device, sector_idx, buffer + bytes_read);
+      else
+        cache_read (fs_device, sector_idx, (void *) (buffer + bytes_read), sector_ofs, chunk_size);
 
       /* Advance. */
       size -= chunk_size;
@@ -465,32 +614,74 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
 
 /* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET.
    Returns the number of bytes actually written, which may be
-   less than SIZE if end of file is reached or an error occurs.
-   (Normally a write at end of file would extend the inode, but
-   growth is not yet implemented.) */
+   less than SIZE if an error occurs.  Extends INODE if the write
+   goes past its end.
+
+   Writes to directories and the free map are metadata, and so
+   is INODE itself when it grows, so those run as a journal
+   transaction.  Files never shrink, so a write that does not
+   extend INODE when checked will not need to later. */
 off_t
-inode_write_at (struct inode *inode, const void *buffer_, off_t size,
+inode_write_at (struct inode *inode, const void *buffer, off_t size,
                 off_t offset)
+{
+  return write_at (inode, buffer, size, offset, false);
+}
+
+/* Like inode_write_at(), but writes whole sectors of file data
+   straight to the disk instead of through the buffer cache,
+   dropping any cached copies.  Shared sectors, and all data
+   with deduplication on, still go through the cache. */
+off_t
+inode_write_at_direct (struct inode *inode, const void *buffer, off_t size,
+                       off_t offset)
+{
+  return write_at (inode, buffer, size, offset, true);
+}
+
+/* Writes SIZE bytes from BUFFER into INODE, starting at OFFSET,
+   bypassing the cache for whole sectors of file data if
+   DIRECT. */
+static off_t
+write_at (struct inode *inode, const void *buffer_, off_t size,
+          off_t offset, bool direct)
 {
   const uint8_t *buffer = buffer_;
   off_t bytes_written = 0;
+  struct inode_disk *id;
+  bool meta, journaled;
 
   if (inode->deny_write_cnt)
     return 0;
 
+  id = read_inode (inode);
+  meta = inode->sector == FREE_MAP_SECTOR || id->is_dir;
+  journaled = (meta || offset + size > id->length || dedup_enabled ()
+               || free_map_any_shared ());
+  free (id);
+
+  if (journaled)
+    journal_begin ();
   lock_acquire (&inode->f_lock);
 
+  if (size > 0)
+    inode->write_gen++;
+
   if (byte_to_sector (inode, offset + size - 1) == (size_t) -1)
     {
-      struct inode_disk *id = read_inode (inode);
-      if (!disk_allocate (id, offset + size))
+      id = read_inode (inode);
+      if (!disk_allocate (id, offset + size, &inode->dirty_blocks))
         {
           free (id);
+          lock_release (&inode->f_lock);
+          if (journaled)
+            journal_end ();
           return bytes_written;
         }
 
       id->length = size + offset;
-      cache_write (fs_device, inode_get_inumber (inode), (void *) id, 0, BLOCK_SECTOR_SIZE);
+      inode->meta_dirty = true;
+      cache_write_meta (fs_device, inode_get_inumber (inode), id, 0, BLOCK_SECTOR_SIZE);
       free (id);
     }
   while (size > 0)
@@ -509,8 +700,21 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       if (chunk_size <= 0)
         break;
 
-      cache_write (fs_device, sector_idx, (void *) (buffer + bytes_written),
-                   sector_ofs, chunk_size);
+      if (meta)
+        cache_write_meta (fs_device, sector_idx, buffer + bytes_written,
+                          sector_ofs, chunk_size);
+      else if (dedup_enabled () || free_map_shared (sector_idx))
+        {
+          if (!dedup_write (inode, offset / BLOCK_SECTOR_SIZE, sector_idx,
+                            buffer + bytes_written, sector_ofs, chunk_size,
+                            &inode->dirty_blocks))
+            break;
+        }
+      else if (!direct || chunk_size < BLOCK_SECTOR_SIZE
+               || !cache_write_direct (fs_device, sector_idx,
+                                       buffer + bytes_written))
+        cache_write (fs_device, sector_idx, (void *) (buffer + bytes_written),
+                     sector_ofs, chunk_size, &inode->dirty_blocks);
 
       /* Advance. */
       size -= chunk_size;
@@ -519,6 +723,8 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
     }
 
   lock_release (&inode->f_lock);
+  if (journaled)
+    journal_end ();
 
   return bytes_written;
 }
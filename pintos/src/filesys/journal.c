@@ -0,0 +1,549 @@
+#include "filesys/journal.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <hash.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/timer.h"
+#include "filesys/cache.h"
+#include "filesys/filesys.h"
+#include "filesys/free-map.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Write-ahead journal for file system metadata.
+
+   Operations that change metadata (inodes, indirect blocks,
+   directory contents and the free map) run as transactions
+   between journal_begin() and journal_end().  Metadata blocks
+   written in a transaction stay pinned in the buffer cache, so
+   that they cannot reach their home locations before the journal
+   holds them.  Transactions are not written out one by one:
+   consecutive ones accumulate into one compound transaction
+   until it has JOURNAL_COMMIT_BLOCKS blocks, is
+   JOURNAL_COMMIT_TICKS old, or someone calls journal_commit().
+   A commit then writes all of its blocks to the log in one
+   sequential run:
+
+     descriptor block: sequence number and home sectors
+     copies of the blocks, one per sector
+     commit block: sequence number and checksum
+
+   after which the blocks are unpinned and the cache writes them
+   home whenever it likes.  When the log has no room left for
+   another full commit, a checkpoint flushes the cache and starts
+   the log over.
+
+   At mount, journal_open() replays every complete commit in the
+   log, in order, and stops at the first one that is missing,
+   torn or left over from before the last checkpoint.
+
+   A metadata sector that is freed and reused for file data must
+   not have its old contents replayed over the data.  Allocating
+   it for data drops it from the running transaction, if it is
+   there, and records a revocation if an earlier commit logged
+   it.  Replay skips blocks revoked by the same or a later
+   commit. */
+
+/* Magic numbers for the journal's on-disk blocks. */
+#define HEADER_MAGIC 0x4a524e4c         /* "JRNL" */
+#define DESC_MAGIC 0x4a445343           /* "JDSC" */
+#define COMMIT_MAGIC 0x4a434d54         /* "JCMT" */
+
+/* A compound transaction is committed at the end of an
+   operation once it has this many blocks or is this many timer
+   ticks old. */
+#define JOURNAL_COMMIT_BLOCKS 16
+#define JOURNAL_COMMIT_TICKS TIMER_FREQ
+
+/* Most revocations in one commit. */
+#define JOURNAL_MAX_REVOKES 64
+
+/* Log size: 1/32 of the device, within these bounds. */
+#define JOURNAL_MIN_SECTORS (2 * (JOURNAL_MAX_BLOCKS + 2))
+#define JOURNAL_MAX_SECTORS 1024
+
+/* Journal header, at JOURNAL_SECTOR.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct journal_header
+  {
+    unsigned magic;             /* HEADER_MAGIC. */
+    block_sector_t start;       /* First sector of the log. */
+    block_sector_t size;        /* Number of sectors in the log. */
+    unsigned seq;               /* Sequence number of first commit. */
+    uint8_t unused[BLOCK_SECTOR_SIZE - 16];
+  };
+
+/* Descriptor block, first in each commit.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct journal_desc
+  {
+    unsigned magic;             /* DESC_MAGIC. */
+    unsigned seq;               /* Sequence number. */
+    unsigned block_cnt;         /* Number of blocks that follow. */
+    unsigned revoke_cnt;        /* Number of revocations. */
+    block_sector_t sectors[JOURNAL_MAX_BLOCKS];  /* Home sectors. */
+    block_sector_t revokes[JOURNAL_MAX_REVOKES]; /* Revoked sectors. */
+    uint8_t unused[BLOCK_SECTOR_SIZE - 16
+                   - 4 * (JOURNAL_MAX_BLOCKS + JOURNAL_MAX_REVOKES)];
+  };
+
+/* Commit block, last in each commit.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct journal_commit
+  {
+    unsigned magic;             /* COMMIT_MAGIC. */
+    unsigned seq;               /* Sequence number. */
+    unsigned checksum;          /* Of the descriptor and blocks. */
+    uint8_t unused[BLOCK_SECTOR_SIZE - 12];
+  };
+
+/* Whether the file system has a journal. */
+static bool enabled;
+
+/* Whether journal_done() leaves the log for the next mount to
+   replay, as power failing right after the last commit would. */
+static bool skip_checkpoint;
+
+/* Held by the thread running a transaction, nesting DEPTH deep.
+   Also protects everything below. */
+static struct lock journal_lock;
+static int depth;
+
+static struct journal_header header;  /* Header as on disk. */
+static block_sector_t head;           /* Next sector to write. */
+static unsigned next_seq;             /* Next commit's number. */
+static struct bitmap *logged;         /* Sectors logged, not revoked. */
+
+/* Running compound transaction.  Its descriptor lists the home
+   sectors of the pinned blocks and the revocations, and the
+   blocks' contents are gathered into txn_data to be written. */
+static struct journal_desc txn;
+static int64_t txn_start;
+static uint8_t txn_data[JOURNAL_MAX_BLOCKS][BLOCK_SECTOR_SIZE];
+
+/* Statistics. */
+static unsigned long long commit_cnt;     /* Commits written. */
+static unsigned long long commit_blocks;  /* Blocks written to log. */
+static unsigned long long checkpoint_cnt; /* Checkpoints. */
+static unsigned long long replay_cnt;     /* Commits replayed. */
+
+static void commit (void);
+static void checkpoint (void);
+static void drop_logged (void);
+static void replay (void);
+static unsigned checksum (const struct journal_desc *,
+                          uint8_t data[][BLOCK_SECTOR_SIZE]);
+static void write_header (void);
+
+/* Creates the journal on a newly formatted file system, with a
+   log allocated from the free map. */
+void
+journal_create (void)
+{
+  static uint8_t zeros[BLOCK_SECTOR_SIZE];
+  block_sector_t size = block_size (fs_device) / 32;
+
+  ASSERT (sizeof (struct journal_header) == BLOCK_SECTOR_SIZE);
+  ASSERT (sizeof (struct journal_desc) == BLOCK_SECTOR_SIZE);
+  ASSERT (sizeof (struct journal_commit) == BLOCK_SECTOR_SIZE);
+
+  if (size < JOURNAL_MIN_SECTORS)
+    size = JOURNAL_MIN_SECTORS;
+  if (size > JOURNAL_MAX_SECTORS)
+    size = JOURNAL_MAX_SECTORS;
+
+  memset (&header, 0, sizeof header);
+  if (free_map_allocate (size, &header.start))
+    {
+      header.magic = HEADER_MAGIC;
+      header.size = size;
+      header.seq = 1;
+
+      /* Make sure that nothing left in the log from before is
+         taken for a commit. */
+      block_write (fs_device, header.start, zeros);
+    }
+  else
+    printf ("No room for a file system journal.\n");
+  write_header ();
+}
+
+/* Opens the journal, if the file system has one, and replays
+   the commits in its log. */
+void
+journal_open (void)
+{
+  lock_init (&journal_lock);
+  block_read (fs_device, JOURNAL_SECTOR, &header);
+  if (header.magic != HEADER_MAGIC
+      || header.size < JOURNAL_MIN_SECTORS
+      || header.start + header.size > block_size (fs_device))
+    {
+      printf ("File system has no journal.\n");
+      return;
+    }
+
+  logged = bitmap_create (block_size (fs_device));
+  if (logged == NULL)
+    PANIC ("journal bitmap creation failed--file system device is too large");
+
+  replay ();
+  enabled = true;
+}
+
+/* Makes journal_done() skip the final checkpoint, for testing
+   replay. */
+void
+journal_skip_checkpoint (void)
+{
+  skip_checkpoint = true;
+}
+
+/* Commits the running transaction and checkpoints, so that the
+   log is empty at the next mount, then closes the journal. */
+void
+journal_done (void)
+{
+  if (!enabled)
+    return;
+
+  lock_acquire (&journal_lock);
+  commit ();
+  if (skip_checkpoint)
+    drop_logged ();
+  else
+    checkpoint ();
+  enabled = false;
+  lock_release (&journal_lock);
+}
+
+/* Starts a transaction, or a nested one if the current thread
+   is already running one.  Only one thread at a time runs a
+   transaction. */
+void
+journal_begin (void)
+{
+  if (lock_held_by_current_thread (&journal_lock))
+    depth++;
+  else if (enabled)
+    {
+      lock_acquire (&journal_lock);
+      depth = 1;
+    }
+}
+
+/* Ends a transaction started by journal_begin().  Ending the
+   outermost one commits the compound transaction if it has
+   grown large or old enough. */
+void
+journal_end (void)
+{
+  if (!lock_held_by_current_thread (&journal_lock) || --depth > 0)
+    return;
+
+  if (txn.block_cnt >= JOURNAL_COMMIT_BLOCKS
+      || (txn.block_cnt + txn.revoke_cnt > 0
+          && timer_elapsed (txn_start) >= JOURNAL_COMMIT_TICKS))
+    commit ();
+  lock_release (&journal_lock);
+}
+
+/* Returns true if the current thread is running a transaction,
+   so that the metadata blocks it writes belong in the journal. */
+bool
+journal_running (void)
+{
+  return lock_held_by_current_thread (&journal_lock);
+}
+
+/* Adds SECTOR, a metadata block that the current transaction
+   wrote and pinned in the cache, to the transaction.  Commits
+   early, splitting the operation, if the transaction is full.
+   Logging SECTOR again cancels any revocation of it pending in
+   the transaction, which would otherwise hide the new copy from
+   replay. */
+void
+journal_add (block_sector_t sector)
+{
+  unsigned i;
+
+  ASSERT (journal_running ());
+
+  for (i = 0; i < txn.block_cnt; i++)
+    if (txn.sectors[i] == sector)
+      return;
+  for (i = 0; i < txn.revoke_cnt; i++)
+    if (txn.revokes[i] == sector)
+      {
+        txn.revokes[i] = txn.revokes[--txn.revoke_cnt];
+        break;
+      }
+
+  if (txn.block_cnt + txn.revoke_cnt == 0)
+    txn_start = timer_ticks ();
+  txn.sectors[txn.block_cnt++] = sector;
+  if (txn.block_cnt == JOURNAL_MAX_BLOCKS)
+    commit ();
+}
+
+/* Notes that SECTOR has been allocated for file data, so that
+   replay must not write any metadata logged for it earlier over
+   the data.  If the running transaction wrote SECTOR as
+   metadata before it was freed, drops it from the transaction
+   and unpins its block, so that the data can be written home. */
+void
+journal_revoke (block_sector_t sector)
+{
+  unsigned i;
+
+  if (!journal_running ())
+    return;
+
+  for (i = 0; i < txn.block_cnt; i++)
+    if (txn.sectors[i] == sector)
+      {
+        txn.sectors[i] = txn.sectors[--txn.block_cnt];
+        cache_unpin (sector);
+        break;
+      }
+
+  for (i = 0; i < txn.revoke_cnt; i++)
+    if (txn.revokes[i] == sector)
+      return;
+  if (!bitmap_test (logged, sector))
+    return;
+
+  if (txn.block_cnt + txn.revoke_cnt == 0)
+    txn_start = timer_ticks ();
+  txn.revokes[txn.revoke_cnt++] = sector;
+  if (txn.revoke_cnt == JOURNAL_MAX_REVOKES)
+    commit ();
+}
+
+/* Commits the running compound transaction, waiting for the
+   current one, if any, to end first. */
+void
+journal_commit (void)
+{
+  if (journal_running ())
+    commit ();
+  else if (enabled)
+    {
+      lock_acquire (&journal_lock);
+      commit ();
+      lock_release (&journal_lock);
+    }
+}
+
+/* Prints journal statistics. */
+void
+journal_print_stats (void)
+{
+  if (header.magic == HEADER_MAGIC)
+    printf ("Journal: %llu commits, %llu blocks, %llu checkpoints, "
+            "%llu replayed\n",
+            commit_cnt, commit_blocks, checkpoint_cnt, replay_cnt);
+}
+
+/* Writes the running compound transaction to the log and unpins
+   its blocks.  Checkpoints afterward if the log cannot hold
+   another full commit. */
+static void
+commit (void)
+{
+  struct journal_commit *c;
+  unsigned i;
+
+  ASSERT (lock_held_by_current_thread (&journal_lock));
+  if (txn.block_cnt + txn.revoke_cnt == 0)
+    return;
+
+  c = calloc (1, sizeof *c);
+  if (c == NULL)
+    PANIC ("journal commit: out of memory");
+
+  txn.magic = DESC_MAGIC;
+  txn.seq = next_seq;
+  for (i = 0; i < txn.block_cnt; i++)
+    cache_read (fs_device, txn.sectors[i], txn_data[i], 0,
+                BLOCK_SECTOR_SIZE);
+  c->magic = COMMIT_MAGIC;
+  c->seq = next_seq;
+  c->checksum = checksum (&txn, txn_data);
+
+  /* One sequential run: descriptor, blocks, commit block.  The
+     commit block goes last, so that a commit interrupted by a
+     crash is incomplete and ignored. */
+  block_write (fs_device, head, &txn);
+  for (i = 0; i < txn.block_cnt; i++)
+    block_write (fs_device, head + 1 + i, txn_data[i]);
+  block_write (fs_device, head + 1 + txn.block_cnt, c);
+  free (c);
+
+  for (i = 0; i < txn.block_cnt; i++)
+    {
+      bitmap_mark (logged, txn.sectors[i]);
+      cache_unpin (txn.sectors[i]);
+    }
+  for (i = 0; i < txn.revoke_cnt; i++)
+    bitmap_reset (logged, txn.revokes[i]);
+  head += txn.block_cnt + 2;
+  next_seq++;
+  commit_cnt++;
+  commit_blocks += txn.block_cnt;
+  memset (&txn, 0, sizeof txn);
+
+  if (header.start + header.size - head < JOURNAL_MAX_BLOCKS + 2)
+    checkpoint ();
+}
+
+/* Writes every committed block home and empties the log.  Must
+   not be called with blocks pinned, since their committed
+   contents would then be lost from the log without reaching
+   home. */
+static void
+checkpoint (void)
+{
+  ASSERT (txn.block_cnt == 0);
+
+  cache_flush (fs_device);
+  header.seq = next_seq;
+  write_header ();
+  head = header.start;
+  bitmap_set_all (logged, false);
+  checkpoint_cnt++;
+}
+
+/* Drops every block that the log holds from the cache, without
+   writing it home, so that only replay can bring it there. */
+static void
+drop_logged (void)
+{
+  size_t sector = 0;
+
+  ASSERT (txn.block_cnt == 0);
+
+  while ((sector = bitmap_scan (logged, sector, 1, true)) != BITMAP_ERROR)
+    cache_discard (sector++);
+}
+
+/* Replays the commits in the log, writing their blocks home,
+   then empties the log. */
+static void
+replay (void)
+{
+  block_sector_t end = header.start + header.size;
+  struct journal_desc *desc = malloc (sizeof *desc);
+  struct journal_commit *c = malloc (sizeof *c);
+  uint8_t (*data)[BLOCK_SECTOR_SIZE] = malloc (sizeof txn_data);
+  block_sector_t *revokes = NULL;
+  unsigned *revoke_seqs = NULL;
+  size_t revoke_cnt = 0;
+  unsigned seq, blocks = 0;
+  block_sector_t pos;
+  int pass;
+
+  if (desc == NULL || c == NULL || data == NULL)
+    PANIC ("journal replay: out of memory");
+
+  /* Pass 0 finds the complete commits and their revocations.
+     Pass 1 writes their blocks home, except those revoked by
+     the same or a later commit. */
+  for (pass = 0; pass < 2; pass++)
+    {
+      seq = header.seq;
+      for (pos = header.start; pos + 2 <= end; pos += desc->block_cnt + 2)
+        {
+          unsigned i;
+
+          block_read (fs_device, pos, desc);
+          if (desc->magic != DESC_MAGIC || desc->seq != seq
+              || desc->block_cnt > JOURNAL_MAX_BLOCKS
+              || desc->revoke_cnt > JOURNAL_MAX_REVOKES
+              || pos + desc->block_cnt + 2 > end)
+            break;
+          for (i = 0; i < desc->block_cnt; i++)
+            block_read (fs_device, pos + 1 + i, data[i]);
+          block_read (fs_device, pos + 1 + desc->block_cnt, c);
+          if (c->magic != COMMIT_MAGIC || c->seq != seq
+              || c->checksum != checksum (desc, data))
+            break;
+
+          if (pass == 0)
+            {
+              size_t cnt = revoke_cnt + desc->revoke_cnt;
+
+              if (desc->revoke_cnt > 0)
+                {
+                  revokes = realloc (revokes, cnt * sizeof *revokes);
+                  revoke_seqs = realloc (revoke_seqs,
+                                         cnt * sizeof *revoke_seqs);
+                  if (revokes == NULL || revoke_seqs == NULL)
+                    PANIC ("journal replay: out of memory");
+                }
+              for (i = 0; i < desc->revoke_cnt; i++)
+                {
+                  revokes[revoke_cnt] = desc->revokes[i];
+                  revoke_seqs[revoke_cnt++] = seq;
+                }
+            }
+          else
+            {
+              for (i = 0; i < desc->block_cnt; i++)
+                {
+                  block_sector_t sector = desc->sectors[i];
+                  size_t r;
+
+                  for (r = 0; r < revoke_cnt; r++)
+                    if (revokes[r] == sector && revoke_seqs[r] >= seq)
+                      break;
+                  if (r == revoke_cnt && sector < block_size (fs_device))
+                    {
+                      block_write (fs_device, sector, data[i]);
+                      blocks++;
+                    }
+                }
+              replay_cnt++;
+            }
+          seq++;
+        }
+    }
+
+  free (revokes);
+  free (revoke_seqs);
+  free (data);
+  free (c);
+  free (desc);
+
+  if (replay_cnt > 0)
+    printf ("Journal: replayed %llu commits (%u blocks).\n",
+            replay_cnt, blocks);
+
+  /* Start the log over. */
+  next_seq = seq;
+  header.seq = next_seq;
+  write_header ();
+  head = header.start;
+}
+
+/* Returns a checksum of DESC and the blocks in DATA that it
+   describes. */
+static unsigned
+checksum (const struct journal_desc *desc,
+          uint8_t data[][BLOCK_SECTOR_SIZE])
+{
+  unsigned sum = hash_bytes (desc, sizeof *desc);
+  unsigned i;
+
+  for (i = 0; i < desc->block_cnt; i++)
+    sum = sum * 31 + hash_bytes (data[i], BLOCK_SECTOR_SIZE);
+  return sum;
+}
+
+/* Writes the header to disk. */
+static void
+write_header (void)
+{
+  block_write (fs_device, JOURNAL_SECTOR, &header);
+}
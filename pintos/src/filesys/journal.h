@@ -0,0 +1,25 @@
+#ifndef FILESYS_JOURNAL_H
+#define FILESYS_JOURNAL_H
+
+#include <stdbool.h>
+#include "devices/block.h"
+
+/* Most metadata blocks in one commit.  Also bounds how many
+   blocks the journal keeps pinned in the buffer cache. */
+#define JOURNAL_MAX_BLOCKS 40
+
+void journal_create (void);
+void journal_open (void);
+void journal_done (void);
+void journal_skip_checkpoint (void);
+
+void journal_begin (void);
+void journal_end (void);
+bool journal_running (void);
+void journal_add (block_sector_t);
+void journal_revoke (block_sector_t);
+void journal_commit (void);
+
+void journal_print_stats (void);
+
+#endif /* filesys/journal.h */
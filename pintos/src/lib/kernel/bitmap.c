@@ -69,6 +69,92 @@ last_mask (const struct bitmap *b)
   return last_bits ? ((elem_type) 1 << last_bits) - 1 : (elem_type) -1;
 }
 
+/* Returns the bits of element IDX that fall between bit START
+   and bit END, exclusive, as a mask.  The element must overlap
+   that range. */
+static inline elem_type
+range_mask (size_t idx, size_t start, size_t end)
+{
+  size_t first = idx * ELEM_BITS;
+  elem_type mask = (elem_type) -1;
+
+  if (start > first)
+    mask &= (elem_type) -1 << (start - first);
+  if (end < first + ELEM_BITS)
+    mask &= ((elem_type) 1 << (end - first)) - 1;
+  return mask;
+}
+
+/* Returns the number of 1-bits in X, counted a bit-pair, nibble,
+   and byte at a time in parallel.  (The CPUs we target lack a
+   population count instruction.) */
+static inline size_t
+elem_popcount (elem_type x)
+{
+  const elem_type m1 = (elem_type) -1 / 3;         /* 0x5555... */
+  const elem_type m2 = (elem_type) -1 / 15 * 3;    /* 0x3333... */
+  const elem_type m4 = (elem_type) -1 / 255 * 15;  /* 0x0f0f... */
+  const elem_type h01 = (elem_type) -1 / 255;      /* 0x0101... */
+
+  x -= (x >> 1) & m1;
+  x = (x & m2) + ((x >> 2) & m2);
+  x = (x + (x >> 4)) & m4;
+  return (x * h01) >> (ELEM_BITS - CHAR_BIT);
+}
+
+/* Atomically sets the bits in MASK in *ELEM to 1.
+
+   This is equivalent to `*elem |= mask' except that it is
+   guaranteed to be atomic on a uniprocessor machine.  See the
+   description of the OR instruction in [IA32-v2b]. */
+static inline void
+elem_or (elem_type *elem, elem_type mask)
+{
+  asm ("or %1, %0" : "+m" (*elem) : "r" (mask) : "cc");
+}
+
+/* Atomically sets the bits in MASK in *ELEM to 0.
+
+   This is equivalent to `*elem &= ~mask' except that it is
+   guaranteed to be atomic on a uniprocessor machine.  See the
+   description of the AND instruction in [IA32-v2a]. */
+static inline void
+elem_and_not (elem_type *elem, elem_type mask)
+{
+  asm ("and %1, %0" : "+m" (*elem) : "r" (~mask) : "cc");
+}
+
+/* Atomically toggles the bits in MASK in *ELEM.
+
+   This is equivalent to `*elem ^= mask' except that it is
+   guaranteed to be atomic on a uniprocessor machine.  See the
+   description of the XOR instruction in [IA32-v2b]. */
+static inline void
+elem_xor (elem_type *elem, elem_type mask)
+{
+  asm ("xor %1, %0" : "+m" (*elem) : "r" (mask) : "cc");
+}
+
+/* Returns the index of the first bit in B between START and END,
+   exclusive, that is set to VALUE, or END if there is none.
+   Skips a whole element at a time over bits that differ. */
+static size_t
+find_next (const struct bitmap *b, size_t start, size_t end, bool value)
+{
+  size_t i;
+
+  if (start >= end)
+    return end;
+  for (i = elem_idx (start); i <= elem_idx (end - 1); i++)
+    {
+      elem_type bits = value ? b->bits[i] : ~b->bits[i];
+      bits &= range_mask (i, start, end);
+      if (bits != 0)
+        return i * ELEM_BITS + __builtin_ctzl (bits);
+    }
+  return end;
+}
+
 /* Creation and destruction. */
 
 /* Creates and returns a pointer to a newly allocated bitmap with room for
@@ -159,10 +245,7 @@ bitmap_mark (struct bitmap *b, size_t bit_idx)
   size_t idx = elem_idx (bit_idx);
   elem_type mask = bit_mask (bit_idx);
 
-  /* This is equivalent to `b->bits[idx] |= mask' except that it
-     is guaranteed to be atomic on a uniprocessor machine.  See
-     the description of the OR instruction in [IA32-v2b]. */
-  asm ("orl %1, %0" : "=m" (b->bits[idx]) : "r" (mask) : "cc");
+  elem_or (&b->bits[idx], mask);
 }
 
 /* Atomically sets the bit numbered BIT_IDX in B to false. */
@@ -172,10 +255,7 @@ bitmap_reset (struct bitmap *b, size_t bit_idx)
   size_t idx = elem_idx (bit_idx);
   elem_type mask = bit_mask (bit_idx);
 
-  /* This is equivalent to `b->bits[idx] &= ~mask' except that it
-     is guaranteed to be atomic on a uniprocessor machine.  See
-     the description of the AND instruction in [IA32-v2a]. */
-  asm ("andl %1, %0" : "=m" (b->bits[idx]) : "r" (~mask) : "cc");
+  elem_and_not (&b->bits[idx], mask);
 }
 
 /* Atomically toggles the bit numbered IDX in B;
@@ -187,10 +267,7 @@ bitmap_flip (struct bitmap *b, size_t bit_idx)
   size_t idx = elem_idx (bit_idx);
   elem_type mask = bit_mask (bit_idx);
 
-  /* This is equivalent to `b->bits[idx] ^= mask' except that it
-     is guaranteed to be atomic on a uniprocessor machine.  See
-     the description of the XOR instruction in [IA32-v2b]. */
-  asm ("xorl %1, %0" : "=m" (b->bits[idx]) : "r" (mask) : "cc");
+  elem_xor (&b->bits[idx], mask);
 }
 
 /* Returns the value of the bit numbered IDX in B. */
@@ -217,14 +294,20 @@ bitmap_set_all (struct bitmap *b, bool value)
 void
 bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
 {
+  size_t end = start + cnt;
   size_t i;
 
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    bitmap_set (b, start + i, value);
+  if (cnt == 0)
+    return;
+  for (i = elem_idx (start); i <= elem_idx (end - 1); i++)
+    if (value)
+      elem_or (&b->bits[i], range_mask (i, start, end));
+    else
+      elem_and_not (&b->bits[i], range_mask (i, start, end));
 }
 
 /* Returns the number of bits in B between START and START + CNT,
@@ -232,6 +315,7 @@ bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
 size_t
 bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 {
+  size_t end = start + cnt;
   size_t i, value_cnt;
 
   ASSERT (b != NULL);
@@ -239,9 +323,12 @@ bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
   ASSERT (start + cnt <= b->bit_cnt);
 
   value_cnt = 0;
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      value_cnt++;
+  if (cnt > 0)
+    for (i = elem_idx (start); i <= elem_idx (end - 1); i++)
+      {
+        elem_type bits = value ? b->bits[i] : ~b->bits[i];
+        value_cnt += elem_popcount (bits & range_mask (i, start, end));
+      }
   return value_cnt;
 }
 
@@ -250,16 +337,11 @@ bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 bool
 bitmap_contains (const struct bitmap *b, size_t start, size_t cnt, bool value)
 {
-  size_t i;
-
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      return true;
-  return false;
+  return find_next (b, start, start + cnt, value) != start + cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
@@ -298,13 +380,28 @@ bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
 
+  if (cnt == 0)
+    return start;
   if (cnt <= b->bit_cnt)
     {
       size_t last = b->bit_cnt - cnt;
-      size_t i;
-      for (i = start; i <= last; i++)
-        if (!bitmap_contains (b, i, cnt, !value))
-          return i;
+      size_t i = start;
+
+      /* Jump to the next bit set to VALUE, then look for a bit
+         that breaks the run within the next CNT bits.  If there
+         is one, no group can start before it. */
+      while (i <= last)
+        {
+          size_t end;
+
+          i = find_next (b, i, last + 1, value);
+          if (i > last)
+            break;
+          end = find_next (b, i, i + cnt, !value);
+          if (end == i + cnt)
+            return i;
+          i = end;
+        }
     }
   return BITMAP_ERROR;
 }
@@ -1,6 +1,7 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
@@ -9,6 +10,8 @@
 
 static void vprintf_helper (char, void *);
 static void putchar_have_lock (uint8_t c);
+static bool use_stage (void);
+static void flush_stage (void);
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
@@ -56,6 +59,16 @@ static bool use_console_lock;
    counter. */
 static int console_lock_depth;
 
+/* Output staged by the thread that holds the console lock, so
+   that the serial and vga layers, which disable interrupts and
+   may touch hardware for every call, see it in batches.  Flushed
+   whenever it fills and whenever the console lock is released,
+   so nothing lingers here after a printf() returns.  Interrupt
+   handlers, and everyone after a panic, bypass it. */
+#define STAGE_SIZE 256
+static char stage[STAGE_SIZE];
+static size_t stage_cnt;
+
 /* Number of characters written to console. */
 static int64_t write_cnt;
 
@@ -73,6 +86,7 @@ console_init (void)
 void
 console_panic (void)
 {
+  flush_stage ();
   use_console_lock = false;
 }
 
@@ -105,7 +119,10 @@ release_console (void)
       if (console_lock_depth > 0)
         console_lock_depth--;
       else
-        lock_release (&console_lock);
+        {
+          flush_stage ();
+          lock_release (&console_lock);
+        }
     }
 }
 
@@ -153,8 +170,25 @@ void
 putbuf (const char *buffer, size_t n)
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  write_cnt += n;
+  if (use_stage ())
+    while (n > 0)
+      {
+        size_t chunk = STAGE_SIZE - stage_cnt;
+        if (chunk > n)
+          chunk = n;
+        memcpy (stage + stage_cnt, buffer, chunk);
+        stage_cnt += chunk;
+        buffer += chunk;
+        n -= chunk;
+        if (stage_cnt == STAGE_SIZE)
+          flush_stage ();
+      }
+  else
+    {
+      serial_putbuf ((const uint8_t *) buffer, n);
+      vga_putbuf (buffer, n);
+    }
   release_console ();
 }
 
@@ -186,6 +220,37 @@ putchar_have_lock (uint8_t c)
 {
   ASSERT (console_locked_by_current_thread ());
   write_cnt++;
-  serial_putc (c);
-  vga_putc (c);
+  if (use_stage ())
+    {
+      stage[stage_cnt++] = c;
+      if (stage_cnt == STAGE_SIZE)
+        flush_stage ();
+    }
+  else
+    {
+      serial_putc (c);
+      vga_putc (c);
+    }
+}
+
+/* Returns true if output should go through the stage, that is,
+   if the current thread holds the console lock. */
+static bool
+use_stage (void)
+{
+  return !intr_context () && use_console_lock;
+}
+
+/* Writes out and empties the stage. */
+static void
+flush_stage (void)
+{
+  size_t n = stage_cnt;
+
+  if (n > 0)
+    {
+      stage_cnt = 0;
+      serial_putbuf ((const uint8_t *) stage, n);
+      vga_putbuf (stage, n);
+    }
 }
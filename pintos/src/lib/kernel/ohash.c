@@ -0,0 +1,462 @@
+/* Open-addressing hash table.
+
+   See ohash.h for basic information. */
+
+#include "ohash.h"
+#include "../debug.h"
+#include "threads/malloc.h"
+
+/* Number of slots in a new or fully shrunk table. */
+#define MIN_SLOTS 16
+
+/* Number of slots of the old slot array moved into the current
+   one by each insertion or deletion while a resize is in
+   progress.  A table grows when it is 3/4 full, doubling its
+   slot count, so moving 2 or more old slots per insertion
+   finishes the move before the new array fills in turn. */
+#define MOVE_SLOTS 8
+
+/* Marks a slot in the old slot array whose element has been
+   moved or deleted.  Unlike an empty slot, it does not end a
+   probe sequence. */
+static struct ohash_elem moved_elem;
+#define MOVED (&moved_elem)
+
+static struct ohash_slot *find_slot (struct ohash *, struct ohash_elem *,
+                                     unsigned hash, struct ohash_table **);
+static bool insert_elem (struct ohash *, struct ohash_elem *, unsigned hash);
+static void remove_slot (struct ohash *, struct ohash_table *,
+                         struct ohash_slot *);
+static void move_slots (struct ohash *, size_t slot_cnt);
+static bool resize (struct ohash *, size_t slot_cnt);
+static bool table_init (struct ohash_table *, size_t slot_cnt);
+static void table_free (struct ohash_table *);
+
+/* Initializes hash table H to compute hash values using HASH and
+   compare hash elements using LESS, given auxiliary data AUX.
+   Returns false if memory allocation fails. */
+bool
+ohash_init (struct ohash *h,
+            ohash_hash_func *hash, ohash_less_func *less, void *aux)
+{
+  h->old.slot_cnt = 0;
+  h->old.elem_cnt = 0;
+  h->old.slots = NULL;
+  h->move_idx = 0;
+  h->hash = hash;
+  h->less = less;
+  h->aux = aux;
+  return table_init (&h->cur, MIN_SLOTS);
+}
+
+/* Removes all the elements from H.
+
+   If DESTRUCTOR is non-null, then it is called for each element
+   in the hash.  DESTRUCTOR may, if appropriate, deallocate the
+   memory used by the hash element.  However, modifying hash
+   table H while ohash_clear() is running, using any of the
+   functions ohash_clear(), ohash_destroy(), ohash_insert(),
+   ohash_replace(), or ohash_delete(), yields undefined behavior,
+   whether done in DESTRUCTOR or elsewhere. */
+void
+ohash_clear (struct ohash *h, ohash_action_func *destructor)
+{
+  size_t i;
+
+  if (destructor != NULL)
+    ohash_apply (h, destructor);
+  table_free (&h->old);
+  for (i = 0; i < h->cur.slot_cnt; i++)
+    h->cur.slots[i].elem = NULL;
+  h->cur.elem_cnt = 0;
+}
+
+/* Destroys hash table H.
+
+   If DESTRUCTOR is non-null, then it is first called for each
+   element in the hash, as for ohash_clear(). */
+void
+ohash_destroy (struct ohash *h, ohash_action_func *destructor)
+{
+  if (destructor != NULL)
+    ohash_apply (h, destructor);
+  table_free (&h->old);
+  table_free (&h->cur);
+}
+
+/* Inserts NEW into hash table H and returns a null pointer, if
+   no equal element is already in the table.
+   If an equal element is already in the table, returns it
+   without inserting NEW.
+   If the table is full and cannot grow, returns NEW without
+   inserting it. */
+struct ohash_elem *
+ohash_insert (struct ohash *h, struct ohash_elem *new)
+{
+  unsigned hash = h->hash (new, h->aux);
+  struct ohash_slot *slot = find_slot (h, new, hash, NULL);
+
+  if (slot != NULL)
+    return slot->elem;
+  return insert_elem (h, new, hash) ? NULL : new;
+}
+
+/* Inserts NEW into hash table H, replacing any equal element
+   already in the table, which is returned.
+   If the table is full and cannot grow, returns NEW without
+   inserting it. */
+struct ohash_elem *
+ohash_replace (struct ohash *h, struct ohash_elem *new)
+{
+  unsigned hash = h->hash (new, h->aux);
+  struct ohash_slot *slot = find_slot (h, new, hash, NULL);
+
+  if (slot != NULL)
+    {
+      struct ohash_elem *old = slot->elem;
+      new->hash = hash;
+      slot->elem = new;
+      return old;
+    }
+  return insert_elem (h, new, hash) ? NULL : new;
+}
+
+/* Finds and returns an element equal to E in hash table H, or a
+   null pointer if no equal element exists in the table. */
+struct ohash_elem *
+ohash_find (struct ohash *h, struct ohash_elem *e)
+{
+  struct ohash_slot *slot = find_slot (h, e, h->hash (e, h->aux), NULL);
+  return slot != NULL ? slot->elem : NULL;
+}
+
+/* Finds, removes, and returns an element equal to E in hash
+   table H.  Returns a null pointer if no equal element existed
+   in the table.
+
+   If the elements of the hash table are dynamically allocated,
+   or own resources that are, then it is the caller's
+   responsibility to deallocate them. */
+struct ohash_elem *
+ohash_delete (struct ohash *h, struct ohash_elem *e)
+{
+  struct ohash_table *table;
+  struct ohash_slot *slot;
+  struct ohash_elem *found;
+
+  slot = find_slot (h, e, h->hash (e, h->aux), &table);
+  if (slot == NULL)
+    return NULL;
+
+  found = slot->elem;
+  remove_slot (h, table, slot);
+  move_slots (h, MOVE_SLOTS);
+
+  /* Shrink once the table is less than 1/8 full. */
+  if (h->old.slots == NULL && h->cur.slot_cnt > MIN_SLOTS
+      && ohash_size (h) < h->cur.slot_cnt / 8)
+    resize (h, h->cur.slot_cnt / 2);
+  return found;
+}
+
+/* Calls ACTION for each element in hash table H in arbitrary
+   order.
+   Modifying hash table H while ohash_apply() is running, using
+   any of the functions ohash_clear(), ohash_destroy(),
+   ohash_insert(), ohash_replace(), or ohash_delete(), yields
+   undefined behavior, whether done from ACTION or elsewhere. */
+void
+ohash_apply (struct ohash *h, ohash_action_func *action)
+{
+  struct ohash_iterator i;
+
+  ASSERT (action != NULL);
+
+  ohash_first (&i, h);
+  while (ohash_next (&i))
+    action (ohash_cur (&i), h->aux);
+}
+
+/* Initializes I for iterating hash table H.
+
+   Iteration idiom:
+
+      struct ohash_iterator i;
+
+      ohash_first (&i, h);
+      while (ohash_next (&i))
+        {
+          struct foo *f = ohash_entry (ohash_cur (&i), struct foo, elem);
+          ...do something with f...
+        }
+
+   Modifying hash table H during iteration, using any of the
+   functions ohash_clear(), ohash_destroy(), ohash_insert(),
+   ohash_replace(), or ohash_delete(), invalidates all
+   iterators. */
+void
+ohash_first (struct ohash_iterator *i, struct ohash *h)
+{
+  ASSERT (i != NULL);
+  ASSERT (h != NULL);
+
+  i->hash = h;
+  i->table = &h->cur;
+  i->slot_idx = 0;
+  i->elem = NULL;
+}
+
+/* Advances I to the next element in the hash table and returns
+   it.  Returns a null pointer if no elements are left.  Elements
+   are returned in arbitrary order.
+
+   Modifying a hash table H during iteration, using any of the
+   functions ohash_clear(), ohash_destroy(), ohash_insert(),
+   ohash_replace(), or ohash_delete(), invalidates all
+   iterators. */
+struct ohash_elem *
+ohash_next (struct ohash_iterator *i)
+{
+  ASSERT (i != NULL);
+
+  for (;;)
+    {
+      while (i->slot_idx < i->table->slot_cnt)
+        {
+          struct ohash_slot *slot = &i->table->slots[i->slot_idx++];
+          if (slot->elem != NULL && slot->elem != MOVED)
+            return i->elem = slot->elem;
+        }
+      if (i->table == &i->hash->old)
+        break;
+      i->table = &i->hash->old;
+      i->slot_idx = 0;
+    }
+  return i->elem = NULL;
+}
+
+/* Returns the current element in the hash table iteration, or a
+   null pointer at the end of the table.  Undefined behavior
+   after calling ohash_first() but before ohash_next(). */
+struct ohash_elem *
+ohash_cur (struct ohash_iterator *i)
+{
+  return i->elem;
+}
+
+/* Returns the number of elements in H. */
+size_t
+ohash_size (struct ohash *h)
+{
+  return h->cur.elem_cnt + h->old.elem_cnt;
+}
+
+/* Returns true if H contains no elements, false otherwise. */
+bool
+ohash_empty (struct ohash *h)
+{
+  return ohash_size (h) == 0;
+}
+
+/* Searches slot array TABLE in H for an element equal to E,
+   whose hash value is HASH.  Returns its slot if found or a null
+   pointer otherwise. */
+static struct ohash_slot *
+table_find (struct ohash *h, struct ohash_table *table,
+            struct ohash_elem *e, unsigned hash)
+{
+  size_t mask = table->slot_cnt - 1;
+  size_t i;
+
+  for (i = hash & mask; table->slots[i].elem != NULL; i = (i + 1) & mask)
+    {
+      struct ohash_slot *slot = &table->slots[i];
+      if (slot->hash == hash && slot->elem != MOVED
+          && !h->less (slot->elem, e, h->aux)
+          && !h->less (e, slot->elem, h->aux))
+        return slot;
+    }
+  return NULL;
+}
+
+/* Searches H for an element equal to E, whose hash value is
+   HASH.  Returns its slot if found or a null pointer otherwise.
+   If TABLE is non-null, stores the slot array that holds the
+   slot in *TABLE. */
+static struct ohash_slot *
+find_slot (struct ohash *h, struct ohash_elem *e, unsigned hash,
+           struct ohash_table **table)
+{
+  struct ohash_slot *slot;
+
+  slot = table_find (h, &h->cur, e, hash);
+  if (slot != NULL)
+    {
+      if (table != NULL)
+        *table = &h->cur;
+      return slot;
+    }
+  if (h->old.slots != NULL)
+    {
+      slot = table_find (h, &h->old, e, hash);
+      if (table != NULL)
+        *table = &h->old;
+    }
+  return slot;
+}
+
+/* Stores E, whose hash value is HASH, in the first free slot of
+   its probe sequence in TABLE.  TABLE must have a free slot. */
+static void
+table_insert (struct ohash_table *table, struct ohash_elem *e, unsigned hash)
+{
+  size_t mask = table->slot_cnt - 1;
+  size_t i;
+
+  ASSERT (table->elem_cnt < table->slot_cnt);
+
+  for (i = hash & mask; table->slots[i].elem != NULL; i = (i + 1) & mask)
+    continue;
+  table->slots[i].hash = hash;
+  table->slots[i].elem = e;
+  table->elem_cnt++;
+}
+
+/* Inserts E, whose hash value is HASH and which is not already
+   in H, into H.  Grows the table first if it is 3/4 full.
+   Returns false if the table is full and cannot grow. */
+static bool
+insert_elem (struct ohash *h, struct ohash_elem *e, unsigned hash)
+{
+  size_t elem_cnt = ohash_size (h) + 1;
+
+  if (elem_cnt > h->cur.slot_cnt / 4 * 3)
+    {
+      /* Finish any move in progress first.  This cannot happen
+         with MOVE_SLOTS large enough, but it costs nothing to
+         be sure. */
+      move_slots (h, SIZE_MAX);
+      resize (h, h->cur.slot_cnt * 2);
+    }
+
+  /* Even if the table could not grow, we may proceed as long as
+     a free slot remains to terminate probe sequences. */
+  if (elem_cnt >= h->cur.slot_cnt)
+    return false;
+
+  e->hash = hash;
+  table_insert (&h->cur, e, hash);
+  move_slots (h, MOVE_SLOTS);
+  return true;
+}
+
+/* Removes SLOT, which is in TABLE, from H. */
+static void
+remove_slot (struct ohash *h, struct ohash_table *table,
+             struct ohash_slot *slot)
+{
+  size_t mask = table->slot_cnt - 1;
+  size_t i, j;
+
+  if (table == &h->old)
+    {
+      /* The old slot array is only ever drained, so mark the slot
+         instead of closing the gap, which could move not yet
+         moved elements behind H->move_idx. */
+      slot->elem = MOVED;
+      if (--table->elem_cnt == 0)
+        table_free (table);
+      return;
+    }
+
+  /* Close the gap by shifting later elements of the same probe
+     run back, so that no probe sequence passes through an empty
+     slot before reaching its element. */
+  i = j = slot - table->slots;
+  for (;;)
+    {
+      size_t home;
+
+      j = (j + 1) & mask;
+      if (table->slots[j].elem == NULL)
+        break;
+
+      /* The element in slot J may move to slot I unless its home
+         slot lies cyclically in (I, J]. */
+      home = table->slots[j].hash & mask;
+      if (i <= j ? i < home && home <= j : i < home || home <= j)
+        continue;
+      table->slots[i] = table->slots[j];
+      i = j;
+    }
+  table->slots[i].elem = NULL;
+  table->elem_cnt--;
+}
+
+/* Moves up to SLOT_CNT slots' worth of elements from H's old
+   slot array into the current one, freeing the old slot array
+   once it is empty. */
+static void
+move_slots (struct ohash *h, size_t slot_cnt)
+{
+  while (h->old.slots != NULL && slot_cnt-- > 0)
+    {
+      struct ohash_slot *slot = &h->old.slots[h->move_idx++];
+      if (slot->elem != NULL && slot->elem != MOVED)
+        {
+          table_insert (&h->cur, slot->elem, slot->hash);
+          slot->elem = MOVED;
+          h->old.elem_cnt--;
+        }
+      if (h->old.elem_cnt == 0 || h->move_idx >= h->old.slot_cnt)
+        table_free (&h->old);
+    }
+}
+
+/* Starts resizing H to a new slot array of SLOT_CNT slots, whose
+   contents will be moved over incrementally.  No resize may be
+   in progress.  This function can fail because of an
+   out-of-memory condition, but that'll just make hash accesses
+   less efficient; we can still continue. */
+static bool
+resize (struct ohash *h, size_t slot_cnt)
+{
+  struct ohash_table table;
+
+  ASSERT (h->old.slots == NULL);
+
+  if (!table_init (&table, slot_cnt))
+    return false;
+  h->old = h->cur;
+  h->cur = table;
+  h->move_idx = 0;
+  if (h->old.elem_cnt == 0)
+    table_free (&h->old);
+  return true;
+}
+
+/* Initializes TABLE as an array of SLOT_CNT empty slots.
+   SLOT_CNT must be a power of 2.  Returns false if memory
+   allocation fails. */
+static bool
+table_init (struct ohash_table *table, size_t slot_cnt)
+{
+  ASSERT (slot_cnt != 0 && (slot_cnt & (slot_cnt - 1)) == 0);
+
+  table->slots = calloc (slot_cnt, sizeof *table->slots);
+  if (table->slots == NULL)
+    return false;
+  table->slot_cnt = slot_cnt;
+  table->elem_cnt = 0;
+  return true;
+}
+
+/* Frees TABLE's slots and marks it as absent. */
+static void
+table_free (struct ohash_table *table)
+{
+  free (table->slots);
+  table->slots = NULL;
+  table->slot_cnt = 0;
+  table->elem_cnt = 0;
+}
@@ -0,0 +1,119 @@
+#ifndef __LIB_KERNEL_OHASH_H
+#define __LIB_KERNEL_OHASH_H
+
+/* Open-addressing hash table.
+
+   A variant of the hash table in hash.h for indexes on hot
+   paths.  Instead of an array of linked lists, the table is a
+   single array of slots, each holding an element pointer and the
+   element's hash value.  Collisions are resolved by linear
+   probing, so a lookup usually touches one or two adjacent
+   slots, and the cached hash values let it skip non-matching
+   slots without touching the elements themselves.
+
+   The interface mirrors hash.h: each structure that can be in
+   an ohash embeds a struct ohash_elem member, and ohash_entry()
+   converts from the member back to the structure.  The hash and
+   comparison functions have the same meaning as for hash.h.
+
+   When the table needs to grow or shrink, it allocates the new
+   slot array and then moves the old entries over a few slots at
+   a time, as part of later insertions and deletions, so that no
+   single operation pays for rehashing the whole table.  Lookups
+   check both arrays while such a move is in progress.
+
+   Unlike hash.h, an ohash can run out of room: ohash_insert()
+   fails, returning its argument, if the table is full and a
+   larger slot array cannot be allocated. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Open-addressing hash element. */
+struct ohash_elem
+  {
+    unsigned hash;              /* Hash value, cached by insertion. */
+  };
+
+/* Converts pointer to hash element OHASH_ELEM into a pointer to
+   the structure that OHASH_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the hash element. */
+#define ohash_entry(OHASH_ELEM, STRUCT, MEMBER)                 \
+        ((STRUCT *) ((uint8_t *) &(OHASH_ELEM)->hash            \
+                     - offsetof (STRUCT, MEMBER.hash)))
+
+/* Computes and returns the hash value for hash element E, given
+   auxiliary data AUX. */
+typedef unsigned ohash_hash_func (const struct ohash_elem *e, void *aux);
+
+/* Compares the value of two hash elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool ohash_less_func (const struct ohash_elem *a,
+                              const struct ohash_elem *b,
+                              void *aux);
+
+/* Performs some operation on hash element E, given auxiliary
+   data AUX. */
+typedef void ohash_action_func (struct ohash_elem *e, void *aux);
+
+/* A slot in a slot array. */
+struct ohash_slot
+  {
+    unsigned hash;              /* Hash value of ELEM. */
+    struct ohash_elem *elem;    /* Element, or null if empty. */
+  };
+
+/* A slot array. */
+struct ohash_table
+  {
+    size_t slot_cnt;            /* Number of slots, a power of 2, or 0. */
+    size_t elem_cnt;            /* Number of elements in SLOTS. */
+    struct ohash_slot *slots;   /* Array of `slot_cnt' slots. */
+  };
+
+/* Open-addressing hash table. */
+struct ohash
+  {
+    struct ohash_table cur;     /* Slot array that takes insertions. */
+    struct ohash_table old;     /* Slot array being moved into CUR. */
+    size_t move_idx;            /* Next slot in OLD to move. */
+    ohash_hash_func *hash;      /* Hash function. */
+    ohash_less_func *less;      /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `hash' and `less'. */
+  };
+
+/* An open-addressing hash table iterator. */
+struct ohash_iterator
+  {
+    struct ohash *hash;         /* The hash table. */
+    struct ohash_table *table;  /* Current slot array. */
+    size_t slot_idx;            /* Index of current slot in TABLE. */
+    struct ohash_elem *elem;    /* Current hash element. */
+  };
+
+/* Basic life cycle. */
+bool ohash_init (struct ohash *, ohash_hash_func *, ohash_less_func *,
+                 void *aux);
+void ohash_clear (struct ohash *, ohash_action_func *);
+void ohash_destroy (struct ohash *, ohash_action_func *);
+
+/* Search, insertion, deletion. */
+struct ohash_elem *ohash_insert (struct ohash *, struct ohash_elem *);
+struct ohash_elem *ohash_replace (struct ohash *, struct ohash_elem *);
+struct ohash_elem *ohash_find (struct ohash *, struct ohash_elem *);
+struct ohash_elem *ohash_delete (struct ohash *, struct ohash_elem *);
+
+/* Iteration. */
+void ohash_apply (struct ohash *, ohash_action_func *);
+void ohash_first (struct ohash_iterator *, struct ohash *);
+struct ohash_elem *ohash_next (struct ohash_iterator *);
+struct ohash_elem *ohash_cur (struct ohash_iterator *);
+
+/* Information. */
+size_t ohash_size (struct ohash *);
+bool ohash_empty (struct ohash *);
+
+#endif /* lib/kernel/ohash.h */
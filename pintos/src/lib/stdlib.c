@@ -3,6 +3,7 @@
 #include <random.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* Converts a string representation of a signed decimal integer
    in S into an `int', which is returned. */
@@ -52,7 +53,7 @@ compare_thunk (const void *a, const void *b, void *aux)
    using COMPARE.  When COMPARE is passed a pair of elements A
    and B, respectively, it must return a strcmp()-type result,
    i.e. less than zero if A < B, zero if A == B, greater than
-   zero if A > B.  Runs in O(n lg n) time and O(1) space in
+   zero if A > B.  Runs in O(n lg n) time and O(lg n) space in
    CNT. */
 void
 qsort (void *array, size_t cnt, size_t size,
@@ -61,54 +62,95 @@ qsort (void *array, size_t cnt, size_t size,
   sort (array, cnt, size, compare_thunk, &compare);
 }
 
-/* Swaps elements with 1-based indexes A_IDX and B_IDX in ARRAY
-   with elements of SIZE bytes each. */
-static void
-do_swap (unsigned char *array, size_t a_idx, size_t b_idx, size_t size)
+/* Word type for swapping elements a word at a time.  May alias
+   whatever type the elements really have. */
+typedef uint32_t __attribute__ ((may_alias)) swap_word;
+
+/* Ranges with at most this many elements are insertion sorted. */
+#define INSERTION_SORT_MAX 10
+
+/* What sort() needs to know about the array it sorts. */
+struct sort_info
+  {
+    size_t size;                /* Element size in bytes. */
+    bool swap_words;            /* Elements are word-aligned words? */
+    int (*compare) (const void *, const void *, void *aux);
+    void *aux;                  /* Auxiliary data for COMPARE. */
+  };
+
+/* Swaps the elements at A and B. */
+static inline void
+do_swap (unsigned char *a, unsigned char *b, const struct sort_info *s)
 {
-  unsigned char *a = array + (a_idx - 1) * size;
-  unsigned char *b = array + (b_idx - 1) * size;
-  size_t i;
+  if (s->swap_words)
+    {
+      swap_word *x = (swap_word *) a;
+      swap_word *y = (swap_word *) b;
+      size_t n = s->size / sizeof *x;
 
-  for (i = 0; i < size; i++)
+      do
+        {
+          swap_word t = *x;
+          *x++ = *y;
+          *y++ = t;
+        }
+      while (--n > 0);
+    }
+  else
     {
-      unsigned char t = a[i];
-      a[i] = b[i];
-      b[i] = t;
+      size_t i;
+
+      for (i = 0; i < s->size; i++)
+        {
+          unsigned char t = a[i];
+          a[i] = b[i];
+          b[i] = t;
+        }
     }
 }
 
-/* Compares elements with 1-based indexes A_IDX and B_IDX in
-   ARRAY with elements of SIZE bytes each, using COMPARE to
-   compare elements, passing AUX as auxiliary data, and returns a
-   strcmp()-type result. */
-static int
-do_compare (unsigned char *array, size_t a_idx, size_t b_idx, size_t size,
-            int (*compare) (const void *, const void *, void *aux),
-            void *aux)
+/* Compares the elements at A and B and returns a strcmp()-type
+   result. */
+static inline int
+do_compare (const unsigned char *a, const unsigned char *b,
+            const struct sort_info *s)
 {
-  return compare (array + (a_idx - 1) * size, array + (b_idx - 1) * size, aux);
+  return s->compare (a, b, s->aux);
 }
 
-/* "Float down" the element with 1-based index I in ARRAY of CNT
-   elements of SIZE bytes each, using COMPARE to compare
-   elements, passing AUX as auxiliary data. */
+/* Sorts the CNT elements at ARRAY by insertion sort, which is
+   the fastest way to sort a handful of elements. */
 static void
-heapify (unsigned char *array, size_t i, size_t cnt, size_t size,
-         int (*compare) (const void *, const void *, void *aux),
-         void *aux)
+insertion_sort (unsigned char *array, size_t cnt, const struct sort_info *s)
+{
+  unsigned char *end = array + cnt * s->size;
+  unsigned char *p, *q;
+
+  for (p = array + s->size; p < end; p += s->size)
+    for (q = p; q > array && do_compare (q - s->size, q, s) > 0; q -= s->size)
+      do_swap (q - s->size, q, s);
+}
+
+/* "Float down" the element with 0-based index I in the heap of
+   CNT elements at ARRAY. */
+static void
+heapify (unsigned char *array, size_t i, size_t cnt,
+         const struct sort_info *s)
 {
   for (;;)
     {
       /* Set `max' to the index of the largest element among I
          and its children (if any). */
-      size_t left = 2 * i;
-      size_t right = 2 * i + 1;
+      size_t left = 2 * i + 1;
+      size_t right = 2 * i + 2;
       size_t max = i;
-      if (left <= cnt && do_compare (array, left, max, size, compare, aux) > 0)
+      if (left < cnt
+          && do_compare (array + left * s->size,
+                         array + max * s->size, s) > 0)
         max = left;
-      if (right <= cnt
-          && do_compare (array, right, max, size, compare, aux) > 0)
+      if (right < cnt
+          && do_compare (array + right * s->size,
+                         array + max * s->size, s) > 0)
         max = right;
 
       /* If the maximum value is already in element I, we're
@@ -117,38 +159,154 @@ heapify (unsigned char *array, size_t i, size_t cnt, size_t size,
         break;
 
       /* Swap and continue down the heap. */
-      do_swap (array, i, max, size);
+      do_swap (array + i * s->size, array + max * s->size, s);
       i = max;
     }
 }
 
+/* Sorts the CNT elements at ARRAY by heapsort, which is slower
+   than quicksort on average but never worse than O(n lg n). */
+static void
+heap_sort (unsigned char *array, size_t cnt, const struct sort_info *s)
+{
+  size_t i;
+
+  /* Build a heap. */
+  for (i = cnt / 2; i > 0; i--)
+    heapify (array, i - 1, cnt, s);
+
+  /* Sort the heap. */
+  for (i = cnt - 1; i > 0; i--)
+    {
+      do_swap (array, array + i * s->size, s);
+      heapify (array, 0, i, s);
+    }
+}
+
+/* Puts the elements at A, B and C in order, so that B holds the
+   median of the three. */
+static void
+order_three (unsigned char *a, unsigned char *b, unsigned char *c,
+             const struct sort_info *s)
+{
+  if (do_compare (a, b, s) > 0)
+    do_swap (a, b, s);
+  if (do_compare (b, c, s) > 0)
+    {
+      do_swap (b, c, s);
+      if (do_compare (a, b, s) > 0)
+        do_swap (a, b, s);
+    }
+}
+
+/* Partitions the CNT elements at ARRAY around the median of its
+   first, middle and last elements.  Returns the pivot's final
+   position, with no greater element before it and no lesser
+   element after it.  CNT must be at least 4. */
+static unsigned char *
+partition (unsigned char *array, size_t cnt, const struct sort_info *s)
+{
+  unsigned char *pivot = array + s->size;
+  unsigned char *last = array + (cnt - 1) * s->size;
+  unsigned char *i, *j;
+
+  /* Order the samples in place, then park the median next to the
+     first element.  The first and last elements then bound both
+     scans, and already sorted or reversed input splits evenly. */
+  order_three (array, array + cnt / 2 * s->size, last, s);
+  do_swap (pivot, array + cnt / 2 * s->size, s);
+
+  /* Scan inward from both ends, stopping at elements equal to the
+     pivot as well as at misplaced ones, so that runs of equal
+     keys are split evenly instead of degrading to O(n^2). */
+  i = pivot;
+  j = last;
+  for (;;)
+    {
+      do
+        i += s->size;
+      while (do_compare (i, pivot, s) < 0);
+      do
+        j -= s->size;
+      while (do_compare (j, pivot, s) > 0);
+      if (i >= j)
+        break;
+      do_swap (i, j, s);
+    }
+  do_swap (pivot, j, s);
+  return j;
+}
+
+/* Sorts the CNT elements at ARRAY by quicksort, switching to
+   heapsort for any range that has been partitioned DEPTH times
+   already, as happens only with adversarial input, and to
+   insertion sort for small ranges.  Recurses only into the
+   smaller side of each partition, so the stack depth stays
+   O(lg n). */
+static void
+intro_sort (unsigned char *array, size_t cnt, unsigned depth,
+            const struct sort_info *s)
+{
+  while (cnt > INSERTION_SORT_MAX)
+    {
+      unsigned char *pivot;
+      size_t left_cnt, right_cnt;
+
+      if (depth-- == 0)
+        {
+          heap_sort (array, cnt, s);
+          return;
+        }
+
+      pivot = partition (array, cnt, s);
+      left_cnt = (pivot - array) / s->size;
+      right_cnt = cnt - left_cnt - 1;
+      if (left_cnt < right_cnt)
+        {
+          intro_sort (array, left_cnt, depth, s);
+          array = pivot + s->size;
+          cnt = right_cnt;
+        }
+      else
+        {
+          intro_sort (pivot + s->size, right_cnt, depth, s);
+          cnt = left_cnt;
+        }
+    }
+  insertion_sort (array, cnt, s);
+}
+
 /* Sorts ARRAY, which contains CNT elements of SIZE bytes each,
    using COMPARE to compare elements, passing AUX as auxiliary
    data.  When COMPARE is passed a pair of elements A and B,
    respectively, it must return a strcmp()-type result, i.e. less
    than zero if A < B, zero if A == B, greater than zero if A >
-   B.  Runs in O(n lg n) time and O(1) space in CNT. */
+   B.  Runs in O(n lg n) time and O(lg n) space in CNT.  The sort
+   is not stable. */
 void
 sort (void *array, size_t cnt, size_t size,
       int (*compare) (const void *, const void *, void *aux),
       void *aux)
 {
-  size_t i;
+  struct sort_info s;
+  unsigned depth;
+  size_t n;
 
   ASSERT (array != NULL || cnt == 0);
   ASSERT (compare != NULL);
   ASSERT (size > 0);
 
-  /* Build a heap. */
-  for (i = cnt / 2; i > 0; i--)
-    heapify (array, i, cnt, size, compare, aux);
+  s.size = size;
+  s.swap_words = ((uintptr_t) array | size) % sizeof (swap_word) == 0;
+  s.compare = compare;
+  s.aux = aux;
 
-  /* Sort the heap. */
-  for (i = cnt; i > 1; i--)
-    {
-      do_swap (array, 1, i, size);
-      heapify (array, 1, i - 1, size, compare, aux);
-    }
+  /* Allow 2 * floor(lg CNT) levels of partitioning. */
+  depth = 0;
+  for (n = cnt; n > 1; n /= 2)
+    depth += 2;
+
+  intro_sort (array, cnt, depth, &s);
 }
 
 /* Searches ARRAY, which contains CNT elements of SIZE bytes
@@ -1,5 +1,19 @@
 #include <string.h>
 #include <debug.h>
+#include <stdint.h>
+
+/* memcpy(), memset(), memcmp() and strlen() work a 32-bit word
+   at a time.  They rely on the direction flag being clear, as the
+   calling convention requires and as the kernel's interrupt
+   entry code ensures.  x86 allows unaligned word accesses, so
+   only the destination of copies is aligned, for the sake of
+   the stores. */
+
+/* A 32-bit word that may alias any other type. */
+typedef uint32_t __attribute__ ((may_alias)) word_t;
+
+/* Blocks shorter than this are handled a byte at a time. */
+#define WORD_THRESHOLD 16
 
 /* Copies SIZE bytes from SRC to DST, which must not overlap.
    Returns DST. */
@@ -12,8 +26,25 @@ memcpy (void *dst_, const void *src_, size_t size)
   ASSERT (dst != NULL || size == 0);
   ASSERT (src != NULL || size == 0);
 
-  while (size-- > 0)
-    *dst++ = *src++;
+  if (size < WORD_THRESHOLD)
+    {
+      /* Too short to pay for setting up string instructions. */
+      while (size-- > 0)
+        *dst++ = *src++;
+      return dst_;
+    }
+
+  /* Copy bytes up to a word boundary in DST, then words, then the
+     bytes left over. */
+  size_t head = -(uintptr_t) dst & (sizeof (word_t) - 1);
+  size_t words = (size - head) / sizeof (word_t);
+  size = (size - head) % sizeof (word_t);
+  asm volatile ("rep movsb"
+                : "+D" (dst), "+S" (src), "+c" (head) : : "memory");
+  asm volatile ("rep movsl"
+                : "+D" (dst), "+S" (src), "+c" (words) : : "memory");
+  asm volatile ("rep movsb"
+                : "+D" (dst), "+S" (src), "+c" (size) : : "memory");
 
   return dst_;
 }
@@ -58,6 +89,16 @@ memcmp (const void *a_, const void *b_, size_t size)
   ASSERT (a != NULL || size == 0);
   ASSERT (b != NULL || size == 0);
 
+  /* Skip over equal words, leaving the first differing word, if
+     any, to the byte loop. */
+  for (; size >= sizeof (word_t); size -= sizeof (word_t))
+    {
+      if (*(const word_t *) a != *(const word_t *) b)
+        break;
+      a += sizeof (word_t);
+      b += sizeof (word_t);
+    }
+
   for (; size-- > 0; a++, b++)
     if (*a != *b)
       return *a > *b ? +1 : -1;
@@ -282,8 +323,26 @@ memset (void *dst_, int value, size_t size)
 
   ASSERT (dst != NULL || size == 0);
 
-  while (size-- > 0)
-    *dst++ = value;
+  if (size < WORD_THRESHOLD)
+    {
+      /* Too short to pay for setting up string instructions. */
+      while (size-- > 0)
+        *dst++ = value;
+      return dst_;
+    }
+
+  /* Set bytes up to a word boundary, then words, then the bytes
+     left over. */
+  size_t head = -(uintptr_t) dst & (sizeof (word_t) - 1);
+  size_t words = (size - head) / sizeof (word_t);
+  word_t word = (unsigned char) value * 0x01010101u;
+  size = (size - head) % sizeof (word_t);
+  asm volatile ("rep stosb"
+                : "+D" (dst), "+c" (head) : "a" (word) : "memory");
+  asm volatile ("rep stosl"
+                : "+D" (dst), "+c" (words) : "a" (word) : "memory");
+  asm volatile ("rep stosb"
+                : "+D" (dst), "+c" (size) : "a" (word) : "memory");
 
   return dst_;
 }
@@ -296,8 +355,22 @@ strlen (const char *string)
 
   ASSERT (string != NULL);
 
-  for (p = string; *p != '\0'; p++)
-    continue;
+  /* Check bytes up to a word boundary, then whole words.  Aligned
+     words never straddle a page boundary, so reading past the
+     terminator cannot fault. */
+  for (p = string; (uintptr_t) p % sizeof (word_t) != 0; p++)
+    if (*p == '\0')
+      return p - string;
+  for (;;)
+    {
+      /* Nonzero if and only if some byte of W is zero. */
+      word_t w = *(const word_t *) p;
+      if (((w - 0x01010101u) & ~w & 0x80808080u) != 0)
+        break;
+      p += sizeof (word_t);
+    }
+  while (*p != '\0')
+    p++;
   return p - string;
 }
 
@@ -32,7 +32,25 @@ enum
     SYS_INUMBER,                /* Returns the inode number for a fd. */
 
     SYS_CACHE_STAT,             /* Returns the requested cache statistic. */
-    SYS_INVALIDATE_CACHE        /* Invalidates the cache blocks. */
+    SYS_INVALIDATE_CACHE,       /* Invalidates the cache blocks. */
+
+    SYS_PIPE,                   /* Creates a pipe. */
+    SYS_EXEC_REDIRECT,          /* Starts a process with redirected stdio. */
+
+    SYS_SYSCALL_STAT,           /* Returns system call statistics. */
+
+    SYS_NONBLOCK,               /* Sets whether reads from a fd wait. */
+
+    SYS_CLOCK_GETTIME,          /* Reads a clock. */
+
+    SYS_VM_STAT,                /* Returns paging statistics. */
+
+    SYS_FSYNC,                  /* Writes a file's data and metadata. */
+    SYS_FDATASYNC,              /* Writes a file's data. */
+
+    SYS_DEFRAG,                 /* Defragments the file system. */
+
+    SYS_DIRECT_IO               /* Sets whether a fd bypasses the cache. */
   };
 
 #endif /* lib/syscall-nr.h */
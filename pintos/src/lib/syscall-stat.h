@@ -0,0 +1,26 @@
+#ifndef __LIB_SYSCALL_STAT_H
+#define __LIB_SYSCALL_STAT_H
+
+#include <stdint.h>
+
+/* System call numbers below this limit are traced. */
+#define SYSCALL_STAT_MAX 64
+
+/* Latency histogram.  Bucket 0 counts calls that took fewer than
+   2**(SYSCALL_HIST_SHIFT + 1) cycles, bucket B > 0 those that took
+   [2**(B + SYSCALL_HIST_SHIFT), 2**(B + SYSCALL_HIST_SHIFT + 1))
+   cycles, and the last bucket everything slower. */
+#define SYSCALL_HIST_BUCKETS 16
+#define SYSCALL_HIST_SHIFT 6
+
+/* Statistics for one system call number, collected by the kernel
+   when started with -sctrace. */
+struct syscall_stat
+  {
+    uint64_t count;                     /* Completed calls. */
+    uint64_t total_cycles;              /* Sum of latencies. */
+    uint64_t max_cycles;                /* Worst latency. */
+    uint32_t hist[SYSCALL_HIST_BUCKETS]; /* Latency histogram. */
+  };
+
+#endif /* lib/syscall-stat.h */
@@ -0,0 +1,18 @@
+#ifndef __LIB_TIME_H
+#define __LIB_TIME_H
+
+#include <stdint.h>
+
+/* Clocks for clock_gettime(). */
+typedef int clockid_t;
+#define CLOCK_REALTIME 0        /* Seconds since the Unix epoch. */
+#define CLOCK_MONOTONIC 1       /* Time since boot. */
+
+/* A time, in seconds and nanoseconds. */
+struct timespec
+  {
+    int64_t tv_sec;             /* Seconds. */
+    int32_t tv_nsec;            /* Nanoseconds, 0...999,999,999. */
+  };
+
+#endif /* lib/time.h */
@@ -0,0 +1,19 @@
+#ifndef __LIB_USER_CPU_H
+#define __LIB_USER_CPU_H
+
+#include <stdint.h>
+
+/* Returns the processor's time-stamp counter, which counts
+   cycles since reset.  User programs may read it directly, so
+   timing code with it costs no system call.  This is the user
+   counterpart of the kernel's threads/cpu.h. */
+static inline uint64_t
+rdtsc (void)
+{
+  /* See [IA32-v2b] "RDTSC". */
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+#endif /* lib/user/cpu.h */
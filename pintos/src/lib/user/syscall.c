@@ -209,3 +209,63 @@ invalidate_cache (void)
 {
   syscall0 (SYS_INVALIDATE_CACHE);
 }
+
+bool
+pipe (int fds[2])
+{
+  return syscall1 (SYS_PIPE, fds);
+}
+
+pid_t
+exec_redirect (const char *cmd_line, int stdin_fd, int stdout_fd)
+{
+  return (pid_t) syscall3 (SYS_EXEC_REDIRECT, cmd_line, stdin_fd, stdout_fd);
+}
+
+bool
+syscall_stat (int nr, bool all, struct syscall_stat *stat)
+{
+  return syscall3 (SYS_SYSCALL_STAT, nr, (int) all, stat);
+}
+
+bool
+nonblock (int fd, bool nonblock)
+{
+  return syscall2 (SYS_NONBLOCK, fd, (int) nonblock);
+}
+
+int
+clock_gettime (clockid_t clock, struct timespec *ts)
+{
+  return syscall2 (SYS_CLOCK_GETTIME, clock, ts);
+}
+
+void
+vm_stat (struct vm_stat *stat)
+{
+  syscall1 (SYS_VM_STAT, stat);
+}
+
+bool
+fsync (int fd)
+{
+  return syscall1 (SYS_FSYNC, fd);
+}
+
+bool
+fdatasync (int fd)
+{
+  return syscall1 (SYS_FDATASYNC, fd);
+}
+
+int
+defrag (void)
+{
+  return syscall0 (SYS_DEFRAG);
+}
+
+bool
+direct_io (int fd, bool direct)
+{
+  return syscall2 (SYS_DIRECT_IO, fd, (int) direct);
+}
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <debug.h>
+#include <syscall-stat.h>
+#include <time.h>
+#include <vm-stat.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -53,4 +56,30 @@ void* sbrk (intptr_t increment);
 int cache_stat (uint32_t flag);
 void invalidate_cache (void);
 
+/* Pipes. */
+bool pipe (int fds[2]);
+pid_t exec_redirect (const char *cmd_line, int stdin_fd, int stdout_fd);
+
+/* System call tracing. */
+bool syscall_stat (int nr, bool all, struct syscall_stat *);
+
+/* Console input. */
+bool nonblock (int fd, bool nonblock);
+
+/* Clocks. */
+int clock_gettime (clockid_t, struct timespec *);
+
+/* Paging statistics. */
+void vm_stat (struct vm_stat *);
+
+/* Durability. */
+bool fsync (int fd);
+bool fdatasync (int fd);
+
+/* Defragmentation. */
+int defrag (void);
+
+/* Direct I/O. */
+bool direct_io (int fd, bool direct);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,15 @@
+#ifndef __LIB_VM_STAT_H
+#define __LIB_VM_STAT_H
+
+#include <stdint.h>
+
+/* Virtual memory statistics, counted since boot, as returned by
+   the vm_stat system call. */
+struct vm_stat
+  {
+    uint64_t page_faults;       /* Page faults, user and kernel. */
+    uint64_t swap_reads;        /* Sectors read from the swap device. */
+    uint64_t swap_writes;       /* Sectors written to the swap device. */
+  };
+
+#endif /* lib/vm-stat.h */
@@ -0,0 +1,65 @@
+/* Support for the file system benchmarks.
+
+   Besides the fields that every benchmark record has, each case
+   reports the buffer cache's hits and misses and the device
+   reads and writes it caused, as
+     hits=N misses=N dev_reads=N dev_writes=N
+   See tests/lib-bench.c. */
+
+#include "tests/filesys/bench/bench.h"
+#include <syscall.h>
+
+/* cache_stat() selectors, as in filesys/cache.h. */
+#define MISS 0
+#define HIT 1
+#define READ 2
+#define WRITE 3
+
+static long long
+read_hits (void)
+{
+  return cache_stat (HIT);
+}
+
+static long long
+read_misses (void)
+{
+  return cache_stat (MISS);
+}
+
+static long long
+read_dev_reads (void)
+{
+  return cache_stat (READ);
+}
+
+static long long
+read_dev_writes (void)
+{
+  return cache_stat (WRITE);
+}
+
+const char *bench_tag = "fsbench";
+
+const struct bench_counter bench_counters[] =
+  {
+    {"hits", read_hits},
+    {"misses", read_misses},
+    {"dev_reads", read_dev_reads},
+    {"dev_writes", read_dev_writes},
+    {NULL, NULL},
+  };
+
+/* Fills the SIZE bytes at BUF with a pattern derived from SEED. */
+void
+bench_fill (void *buf_, size_t size, unsigned seed)
+{
+  unsigned char *buf = buf_;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      buf[i] = seed >> 16;
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef TESTS_FILESYS_BENCH_BENCH_H
+#define TESTS_FILESYS_BENCH_BENCH_H
+
+#include <stddef.h>
+#include "tests/lib-bench.h"
+
+void bench_fill (void *buf, size_t size, unsigned seed);
+
+#endif /* tests/filesys/bench/bench.h */
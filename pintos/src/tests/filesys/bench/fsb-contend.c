@@ -0,0 +1,118 @@
+/* Multi-process contention.  Runs 1, 2 and 4 copies of itself at
+   once, each either writing and reading back its own file or
+   reading one shared file, and reports the aggregate throughput.
+
+   Usage: fsb-contend [child own|shared ID] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+
+#define FILE_SIZE (128 * 1024)
+#define BLOCK_SIZE 4096
+#define MAX_CHILDREN 4
+
+static char buf[BLOCK_SIZE];
+
+/* Reads all of the file open as FD in BLOCK_SIZE blocks. */
+static void
+read_file (int fd)
+{
+  int ofs;
+
+  for (ofs = 0; ofs < FILE_SIZE; ofs += BLOCK_SIZE)
+    if (read (fd, buf, BLOCK_SIZE) != BLOCK_SIZE)
+      bench_fail ("read at offset %d", ofs);
+}
+
+/* Writes a FILE_SIZE file named NAME. */
+static void
+write_file (const char *name)
+{
+  int fd, ofs;
+
+  if (!create (name, 0) || (fd = open (name)) < 0)
+    bench_fail ("create \"%s\"", name);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += BLOCK_SIZE)
+    if (write (fd, buf, BLOCK_SIZE) != BLOCK_SIZE)
+      bench_fail ("write at offset %d", ofs);
+  close (fd);
+}
+
+/* Child process: writes and reads back its own file, or reads
+   the shared file. */
+static int
+child (const char *mode, const char *id)
+{
+  char name[16];
+  int fd;
+
+  bench_fill (buf, sizeof buf, atoi (id));
+  if (!strcmp (mode, "own"))
+    {
+      snprintf (name, sizeof name, "own%s", id);
+      write_file (name);
+    }
+  else
+    strlcpy (name, "shared", sizeof name);
+
+  if ((fd = open (name)) < 0)
+    bench_fail ("open \"%s\"", name);
+  read_file (fd);
+  close (fd);
+  return 0;
+}
+
+/* Runs CNT children in MODE at once and reports the aggregate
+   rate. */
+static void
+run (const char *self, const char *mode, int cnt)
+{
+  bool own = !strcmp (mode, "own");
+  int passes = own ? 2 : 1;     /* Own files are written, then read. */
+  pid_t pids[MAX_CHILDREN];
+  char cmd[64], params[32];
+  struct bench b;
+  int i;
+
+  snprintf (params, sizeof params, "procs=%d bs=%d", cnt, BLOCK_SIZE);
+  invalidate_cache ();
+  bench_start (&b, own ? "contend-own" : "contend-shared");
+  for (i = 0; i < cnt; i++)
+    {
+      snprintf (cmd, sizeof cmd, "%s child %s %d", self, mode, i);
+      if ((pids[i] = exec (cmd)) == PID_ERROR)
+        bench_fail ("exec \"%s\"", cmd);
+    }
+  for (i = 0; i < cnt; i++)
+    if (wait (pids[i]) != 0)
+      bench_fail ("child %d failed", i);
+  bench_stop (&b, params, (uint64_t) cnt * passes * FILE_SIZE / BLOCK_SIZE,
+              (uint64_t) cnt * passes * FILE_SIZE);
+
+  for (i = 0; i < cnt && own; i++)
+    {
+      snprintf (cmd, sizeof cmd, "own%d", i);
+      remove (cmd);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int cnt;
+
+  if (argc == 4 && !strcmp (argv[1], "child"))
+    return child (argv[2], argv[3]);
+
+  bench_fill (buf, sizeof buf, 0);
+  write_file ("shared");
+  for (cnt = 1; cnt <= MAX_CHILDREN; cnt *= 2)
+    {
+      run (argv[0], "own", cnt);
+      run (argv[0], "shared", cnt);
+    }
+  return 0;
+}
@@ -0,0 +1,71 @@
+/* Large-directory operations: filling one directory with many
+   entries, looking entries up in random order, listing it, and
+   emptying it again. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+
+#define ENTRY_CNT 300
+
+/* Writes the name of entry I into NAME. */
+static void
+entry_name (char name[READDIR_MAX_LEN + 1], int i)
+{
+  snprintf (name, READDIR_MAX_LEN + 1, "e%03d", i);
+}
+
+int
+main (void)
+{
+  char name[READDIR_MAX_LEN + 1];
+  char params[16];
+  struct bench b;
+  int i, fd, cnt;
+
+  snprintf (params, sizeof params, "entries=%d", ENTRY_CNT);
+  if (!mkdir ("big") || !chdir ("big"))
+    bench_fail ("mkdir \"big\"");
+
+  bench_start (&b, "dir-create");
+  for (i = 0; i < ENTRY_CNT; i++)
+    {
+      entry_name (name, i);
+      if (!create (name, 0))
+        bench_fail ("create \"%s\"", name);
+    }
+  bench_stop (&b, params, ENTRY_CNT, 0);
+
+  random_init (0);
+  bench_start (&b, "dir-lookup");
+  for (i = 0; i < ENTRY_CNT; i++)
+    {
+      entry_name (name, random_ulong () % ENTRY_CNT);
+      if ((fd = open (name)) < 0)
+        bench_fail ("open \"%s\"", name);
+      close (fd);
+    }
+  bench_stop (&b, params, ENTRY_CNT, 0);
+
+  bench_start (&b, "dir-list");
+  if ((fd = open (".")) < 0)
+    bench_fail ("open \".\"");
+  for (cnt = 0; readdir (fd, name); cnt++)
+    continue;
+  close (fd);
+  bench_stop (&b, params, cnt, 0);
+  if (cnt != ENTRY_CNT)
+    bench_fail ("readdir returned %d entries, expected %d", cnt, ENTRY_CNT);
+
+  bench_start (&b, "dir-remove");
+  for (i = 0; i < ENTRY_CNT; i++)
+    {
+      entry_name (name, i);
+      if (!remove (name))
+        bench_fail ("remove \"%s\"", name);
+    }
+  bench_stop (&b, params, ENTRY_CNT, 0);
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+/* Fragmentation.  Grows two 512 kB files together, one block at
+   a time, so that their blocks interleave on disk, and reads one
+   back with a cold cache.  Then runs the defragmenter and reads
+   it back again, to show what contiguous placement buys. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+
+#define FILE_SIZE (512 * 1024)
+#define BLOCK_SIZE 512
+#define READ_SIZE 4096
+
+static char buf[READ_SIZE];
+
+/* Reads all of FILE with a cold cache, timing it as case NAME. */
+static void
+read_cold (const char *file, const char *name, const char *params)
+{
+  struct bench b;
+  int fd, ofs;
+
+  if ((fd = open (file)) < 0)
+    bench_fail ("open \"%s\"", file);
+  invalidate_cache ();
+  bench_start (&b, name);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += READ_SIZE)
+    if (read (fd, buf, READ_SIZE) != READ_SIZE)
+      bench_fail ("read at offset %d", ofs);
+  bench_stop (&b, params, FILE_SIZE / READ_SIZE, FILE_SIZE);
+  close (fd);
+}
+
+int
+main (void)
+{
+  const char *files[] = {"frag-a", "frag-b"};
+  char params[32];
+  struct bench b;
+  int fds[2];
+  int i, ofs, moved;
+
+  bench_fill (buf, sizeof buf, 6);
+  for (i = 0; i < 2; i++)
+    if (!create (files[i], 0) || (fds[i] = open (files[i])) < 0)
+      bench_fail ("create \"%s\"", files[i]);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += BLOCK_SIZE)
+    for (i = 0; i < 2; i++)
+      if (write (fds[i], buf, BLOCK_SIZE) != BLOCK_SIZE)
+        bench_fail ("write \"%s\" at offset %d", files[i], ofs);
+  for (i = 0; i < 2; i++)
+    close (fds[i]);
+
+  read_cold (files[0], "frag-read-before", NULL);
+
+  bench_start (&b, "defrag");
+  moved = defrag ();
+  snprintf (params, sizeof params, "moved=%d", moved);
+  bench_stop (&b, params, moved, moved * BLOCK_SIZE);
+
+  read_cold (files[0], "frag-read-after", NULL);
+
+  for (i = 0; i < 2; i++)
+    if (!remove (files[i]))
+      bench_fail ("remove \"%s\"", files[i]);
+  return 0;
+}
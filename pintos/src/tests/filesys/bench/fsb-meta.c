@@ -0,0 +1,67 @@
+/* Metadata operation rates: creating, opening, "stat"ing (open,
+   filesize, close) and removing many small files in the root
+   directory. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+
+#define FILE_CNT 100
+
+/* Writes the name of file I into NAME. */
+static void
+file_name (char name[16], int i)
+{
+  snprintf (name, 16, "m%d", i);
+}
+
+int
+main (void)
+{
+  char name[16];
+  char params[16];
+  struct bench b;
+  int i, fd;
+
+  snprintf (params, sizeof params, "files=%d", FILE_CNT);
+
+  bench_start (&b, "create");
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      file_name (name, i);
+      if (!create (name, 512))
+        bench_fail ("create \"%s\"", name);
+    }
+  bench_stop (&b, params, FILE_CNT, 0);
+
+  bench_start (&b, "open-close");
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      file_name (name, i);
+      if ((fd = open (name)) < 0)
+        bench_fail ("open \"%s\"", name);
+      close (fd);
+    }
+  bench_stop (&b, params, FILE_CNT, 0);
+
+  bench_start (&b, "stat");
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      file_name (name, i);
+      if ((fd = open (name)) < 0 || filesize (fd) != 512)
+        bench_fail ("stat \"%s\"", name);
+      close (fd);
+    }
+  bench_stop (&b, params, FILE_CNT, 0);
+
+  bench_start (&b, "unlink");
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      file_name (name, i);
+      if (!remove (name))
+        bench_fail ("remove \"%s\"", name);
+    }
+  bench_stop (&b, params, FILE_CNT, 0);
+
+  return 0;
+}
@@ -0,0 +1,63 @@
+/* Random-access throughput.  For each block size, reads and then
+   writes blocks at random block-aligned offsets in a 512 kB file,
+   starting from a cold cache. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+
+#define FILE_SIZE (512 * 1024)
+#define OPS 1024
+
+static char buf[4096];
+
+int
+main (void)
+{
+  static const int sizes[] = {512, 4096};
+  const char *file = "random";
+  size_t i;
+  int fd, ofs;
+
+  /* Lay the file out in one pass first. */
+  bench_fill (buf, sizeof buf, 2);
+  if (!create (file, 0) || (fd = open (file)) < 0)
+    bench_fail ("create \"%s\"", file);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += sizeof buf)
+    if (write (fd, buf, sizeof buf) != (int) sizeof buf)
+      bench_fail ("write at offset %d", ofs);
+
+  random_init (0);
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    {
+      int bs = sizes[i];
+      char params[16];
+      struct bench b;
+      int op;
+
+      snprintf (params, sizeof params, "bs=%d", bs);
+
+      invalidate_cache ();
+      bench_start (&b, "random-read");
+      for (op = 0; op < OPS; op++)
+        {
+          seek (fd, random_ulong () % (FILE_SIZE / bs) * bs);
+          if (read (fd, buf, bs) != bs)
+            bench_fail ("random read of %d bytes", bs);
+        }
+      bench_stop (&b, params, OPS, (uint64_t) OPS * bs);
+
+      bench_start (&b, "random-write");
+      for (op = 0; op < OPS; op++)
+        {
+          seek (fd, random_ulong () % (FILE_SIZE / bs) * bs);
+          if (write (fd, buf, bs) != bs)
+            bench_fail ("random write of %d bytes", bs);
+        }
+      bench_stop (&b, params, OPS, (uint64_t) OPS * bs);
+    }
+
+  close (fd);
+  return 0;
+}
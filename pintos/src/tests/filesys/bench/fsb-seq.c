@@ -0,0 +1,65 @@
+/* Sequential throughput.  For each block size, writes a 1 MB file
+   from scratch, then reads it back twice: once with a cold cache
+   and once with whatever the first pass left in it. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/filesys/bench/bench.h"
+
+#define FILE_SIZE (1024 * 1024)
+
+static char buf[16384];
+
+/* Reads all of FILE in BS-byte blocks, timing it as case NAME. */
+static void
+read_all (const char *file, const char *name, const char *params, int bs)
+{
+  struct bench b;
+  int fd, ofs;
+
+  if ((fd = open (file)) < 0)
+    bench_fail ("open \"%s\"", file);
+  bench_start (&b, name);
+  for (ofs = 0; ofs < FILE_SIZE; ofs += bs)
+    if (read (fd, buf, bs) != bs)
+      bench_fail ("read %d bytes at offset %d", bs, ofs);
+  bench_stop (&b, params, FILE_SIZE / bs, FILE_SIZE);
+  close (fd);
+}
+
+int
+main (void)
+{
+  static const int sizes[] = {512, 4096, 16384};
+  const char *file = "seq";
+  size_t i;
+
+  bench_fill (buf, sizeof buf, 1);
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    {
+      int bs = sizes[i];
+      char params[16];
+      struct bench b;
+      int fd, ofs;
+
+      snprintf (params, sizeof params, "bs=%d", bs);
+
+      if (!create (file, 0) || (fd = open (file)) < 0)
+        bench_fail ("create \"%s\"", file);
+      bench_start (&b, "seq-write");
+      for (ofs = 0; ofs < FILE_SIZE; ofs += bs)
+        if (write (fd, buf, bs) != bs)
+          bench_fail ("write %d bytes at offset %d", bs, ofs);
+      close (fd);
+      bench_stop (&b, params, FILE_SIZE / bs, FILE_SIZE);
+
+      invalidate_cache ();
+      read_all (file, "seq-read-cold", params, bs);
+      read_all (file, "seq-read-warm", params, bs);
+
+      if (!remove (file))
+        bench_fail ("remove \"%s\"", file);
+    }
+  return 0;
+}
@@ -0,0 +1,37 @@
+/* First boot of dedup-reboot, run with deduplication on.
+   Writes the same blocks to "a" and then to "b", so that "b"
+   shares all of its sectors with "a". */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/filesys/extended/dedup-reboot.h"
+#include "tests/lib.h"
+
+const char *test_name = "child-dedup";
+
+static char buf[BUF_SIZE];
+
+/* Creates FILE_NAME and writes buf[] to it. */
+static void
+write_file (const char *file_name)
+{
+  int fd;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (write (fd, buf, BUF_SIZE) == BUF_SIZE,
+         "write %d bytes to \"%s\"", BUF_SIZE, file_name);
+  CHECK (fsync (fd), "fsync \"%s\"", file_name);
+  close (fd);
+}
+
+int
+main (void)
+{
+  random_init (0);
+  random_bytes (buf, sizeof buf);
+
+  write_file ("a");
+  write_file ("b");
+  return 0;
+}
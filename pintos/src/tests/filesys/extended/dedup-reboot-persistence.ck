@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::random;
+my ($old) = random_bytes (2048);
+my ($new) = random_bytes (2048);
+check_archive ({"a" => [$new], "b" => [$old], "child-dedup" => "tests/filesys/extended/child-dedup"});
+pass;
@@ -0,0 +1,41 @@
+/* Second boot of dedup-reboot, run with deduplication off after
+   child-dedup has made "a" and "b" share their sectors.  The
+   reference counts are still on disk, so rewriting "a", through
+   the cache and through direct I/O, must copy each shared sector
+   instead of writing it in place, leaving "b" as it was. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/filesys/extended/dedup-reboot.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define HALF_SIZE (BUF_SIZE / 2)
+
+static char old_buf[BUF_SIZE];
+static char new_buf[BUF_SIZE];
+
+void
+test_main (void)
+{
+  int fd;
+
+  random_init (0);
+  random_bytes (old_buf, sizeof old_buf);
+  random_bytes (new_buf, sizeof new_buf);
+
+  check_file ("b", old_buf, BUF_SIZE);
+
+  CHECK ((fd = open ("a")) > 1, "open \"a\"");
+  CHECK (write (fd, new_buf, HALF_SIZE) == HALF_SIZE,
+         "write %d bytes to \"a\"", HALF_SIZE);
+  CHECK (direct_io (fd, true), "direct_io \"a\"");
+  CHECK (write (fd, new_buf + HALF_SIZE, HALF_SIZE) == HALF_SIZE,
+         "write %d more bytes to \"a\"", HALF_SIZE);
+  CHECK (fsync (fd), "fsync \"a\"");
+  msg ("close \"a\"");
+  close (fd);
+
+  check_file ("a", new_buf, BUF_SIZE);
+  check_file ("b", old_buf, BUF_SIZE);
+}
@@ -0,0 +1,31 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+
+# The first boot must have shared the blocks of "b" with "a".
+my (@setup) = read_text_file ("$test-setup.output");
+fail "First boot did not share any blocks.\n"
+  if !grep (/^Dedup: [1-9]\d* blocks shared/, @setup);
+
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dedup-reboot) begin
+(dedup-reboot) open "b" for verification
+(dedup-reboot) verified contents of "b"
+(dedup-reboot) close "b"
+(dedup-reboot) open "a"
+(dedup-reboot) write 1024 bytes to "a"
+(dedup-reboot) direct_io "a"
+(dedup-reboot) write 1024 more bytes to "a"
+(dedup-reboot) fsync "a"
+(dedup-reboot) close "a"
+(dedup-reboot) open "a" for verification
+(dedup-reboot) verified contents of "a"
+(dedup-reboot) close "a"
+(dedup-reboot) open "b" for verification
+(dedup-reboot) verified contents of "b"
+(dedup-reboot) close "b"
+(dedup-reboot) end
+EOF
+pass;
@@ -0,0 +1,8 @@
+#ifndef TESTS_FILESYS_EXTENDED_DEDUP_REBOOT_H
+#define TESTS_FILESYS_EXTENDED_DEDUP_REBOOT_H
+
+#define BLOCK_SECTOR_SIZE 512
+#define BLOCK_CNT 4
+#define BUF_SIZE (BLOCK_SECTOR_SIZE * BLOCK_CNT)
+
+#endif /* tests/filesys/extended/dedup-reboot.h */
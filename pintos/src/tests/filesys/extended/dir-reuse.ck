@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-reuse) begin
+(dir-reuse) mkdir "d"
+(dir-reuse) rmdir "d"
+(dir-reuse) create "b"
+(dir-reuse) open "b"
+(dir-reuse) write 512 bytes to "b"
+(dir-reuse) fsync "b"
+(dir-reuse) read back "b"
+(dir-reuse) close "b"
+(dir-reuse) end
+EOF
+pass;
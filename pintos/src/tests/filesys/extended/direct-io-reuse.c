@@ -0,0 +1,45 @@
+/* Removes a directory and at once writes a file through direct
+   I/O, so that the write lands in the directory's data sector
+   while the transaction that freed it is still open.  Checks
+   that the data reads back, directly and through the cache. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SECTOR_SIZE 512
+
+static char buf[BLOCK_SECTOR_SIZE];
+static char check[BLOCK_SECTOR_SIZE];
+
+void
+test_main (void)
+{
+  const char *file_name = "b";
+  int fd;
+
+  CHECK (mkdir ("d"), "mkdir \"d\"");
+  CHECK (remove ("d"), "rmdir \"d\"");
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (direct_io (fd, true), "direct_io \"%s\"", file_name);
+
+  random_bytes (buf, sizeof buf);
+  CHECK (write (fd, buf, sizeof buf) == BLOCK_SECTOR_SIZE,
+         "write %d bytes to \"%s\"", BLOCK_SECTOR_SIZE, file_name);
+  seek (fd, 0);
+  CHECK (read (fd, check, sizeof check) == BLOCK_SECTOR_SIZE
+         && !memcmp (buf, check, sizeof buf),
+         "direct read of \"%s\" matches", file_name);
+  close (fd);
+
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (read (fd, check, sizeof check) == BLOCK_SECTOR_SIZE
+         && !memcmp (buf, check, sizeof buf),
+         "cached read of \"%s\" matches", file_name);
+  msg ("close \"%s\"", file_name);
+  close (fd);
+  remove (file_name);
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(direct-io-reuse) begin
+(direct-io-reuse) mkdir "d"
+(direct-io-reuse) rmdir "d"
+(direct-io-reuse) create "b"
+(direct-io-reuse) open "b"
+(direct-io-reuse) direct_io "b"
+(direct-io-reuse) write 512 bytes to "b"
+(direct-io-reuse) direct read of "b" matches
+(direct-io-reuse) open "b"
+(direct-io-reuse) cached read of "b" matches
+(direct-io-reuse) close "b"
+(direct-io-reuse) end
+EOF
+pass;
@@ -0,0 +1,92 @@
+/* Reads a small file to bring it into the cache, then streams a
+   file several times the size of the cache through direct I/O,
+   both ways.  Checks that the streamed data reads back intact,
+   through the cache too, and that the small file is still
+   cached afterward. */
+
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SECTOR_SIZE 512
+#define HOT_SIZE (BLOCK_SECTOR_SIZE * 8)
+#define BIG_SIZE (BLOCK_SECTOR_SIZE * 256)
+#define CHUNK_SIZE (BLOCK_SECTOR_SIZE * 8)
+
+/* From cache.h */
+#define MISS 0
+
+static char hot[HOT_SIZE];
+static char chunk[CHUNK_SIZE];
+static char check[CHUNK_SIZE];
+
+/* Reads all of FILE_NAME, HOT_SIZE bytes, into hot[]. */
+static void
+read_hot (const char *file_name)
+{
+  int fd;
+
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (read (fd, hot, HOT_SIZE) == HOT_SIZE,
+         "read %d bytes from \"%s\"", HOT_SIZE, file_name);
+  close (fd);
+}
+
+void
+test_main (void)
+{
+  const char *hot_name = "hot";
+  const char *big_name = "big";
+  long long misses;
+  int fd, ofs;
+
+  CHECK (create (hot_name, 0), "create \"%s\"", hot_name);
+  CHECK ((fd = open (hot_name)) > 1, "open \"%s\"", hot_name);
+  random_bytes (hot, sizeof hot);
+  CHECK (write (fd, hot, HOT_SIZE) == HOT_SIZE,
+         "write %d bytes to \"%s\"", HOT_SIZE, hot_name);
+  close (fd);
+  read_hot (hot_name);
+
+  /* Stream the big file out and back in. */
+  CHECK (create (big_name, 0), "create \"%s\"", big_name);
+  CHECK ((fd = open (big_name)) > 1, "open \"%s\"", big_name);
+  CHECK (direct_io (fd, true), "direct_io \"%s\"", big_name);
+  for (ofs = 0; ofs < BIG_SIZE; ofs += CHUNK_SIZE)
+    {
+      memset (chunk, ofs / CHUNK_SIZE, sizeof chunk);
+      if (write (fd, chunk, CHUNK_SIZE) != CHUNK_SIZE)
+        fail ("write at offset %d failed", ofs);
+    }
+  msg ("write %d bytes to \"%s\"", BIG_SIZE, big_name);
+  seek (fd, 0);
+  for (ofs = 0; ofs < BIG_SIZE; ofs += CHUNK_SIZE)
+    {
+      memset (check, ofs / CHUNK_SIZE, sizeof check);
+      if (read (fd, chunk, CHUNK_SIZE) != CHUNK_SIZE
+          || memcmp (chunk, check, CHUNK_SIZE))
+        fail ("read at offset %d differs", ofs);
+    }
+  msg ("read %d bytes from \"%s\"", BIG_SIZE, big_name);
+  close (fd);
+
+  misses = cache_stat (MISS);
+  read_hot (hot_name);
+  CHECK (cache_stat (MISS) == misses, "\"%s\" is still cached", hot_name);
+
+  /* The cache sees what went around it. */
+  CHECK ((fd = open (big_name)) > 1, "open \"%s\"", big_name);
+  seek (fd, BIG_SIZE - CHUNK_SIZE);
+  memset (check, BIG_SIZE / CHUNK_SIZE - 1, sizeof check);
+  CHECK (read (fd, chunk, CHUNK_SIZE) == CHUNK_SIZE
+         && !memcmp (chunk, check, CHUNK_SIZE),
+         "cached read of \"%s\" matches", big_name);
+  close (fd);
+
+  CHECK (!direct_io (STDOUT_FILENO, true), "direct_io console fails");
+  remove (big_name);
+  remove (hot_name);
+}
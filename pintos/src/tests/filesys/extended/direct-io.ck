@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(direct-io) begin
+(direct-io) create "hot"
+(direct-io) open "hot"
+(direct-io) write 4096 bytes to "hot"
+(direct-io) open "hot"
+(direct-io) read 4096 bytes from "hot"
+(direct-io) create "big"
+(direct-io) open "big"
+(direct-io) direct_io "big"
+(direct-io) write 131072 bytes to "big"
+(direct-io) read 131072 bytes from "big"
+(direct-io) open "hot"
+(direct-io) read 4096 bytes from "hot"
+(direct-io) "hot" is still cached
+(direct-io) open "big"
+(direct-io) cached read of "big" matches
+(direct-io) direct_io console fails
+(direct-io) end
+EOF
+pass;
@@ -0,0 +1,82 @@
+/* Runs with deduplication on.  Rewrites one file with blocks
+   that another file has written but not synced, and checks that
+   fsync() writes those shared blocks.  Then rewrites one block in
+   place with the contents of another, which only moves it in the
+   block map, and checks that fdatasync() writes the map. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SECTOR_SIZE 512
+#define BLOCK_CNT 4
+#define BUF_SIZE (BLOCK_SECTOR_SIZE * BLOCK_CNT)
+
+/* From cache.h */
+#define WRITE 3
+
+static char a_buf[BUF_SIZE];
+static char b_buf[BUF_SIZE];
+static char check[BUF_SIZE];
+
+/* Creates FILE_NAME, writes BUF to it, and returns its fd. */
+static int
+create_file (const char *file_name, const char *buf)
+{
+  int fd;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((fd = open (file_name)) > 1, "open \"%s\"", file_name);
+  CHECK (write (fd, buf, BUF_SIZE) == BUF_SIZE,
+         "write %d bytes to \"%s\"", BUF_SIZE, file_name);
+  return fd;
+}
+
+void
+test_main (void)
+{
+  long long writes;
+  int a_fd, b_fd;
+
+  random_bytes (a_buf, sizeof a_buf);
+  random_bytes (b_buf, sizeof b_buf);
+
+  b_fd = create_file ("b", b_buf);
+  CHECK (fsync (b_fd), "fsync \"b\"");
+  a_fd = create_file ("a", a_buf);
+
+  /* "b" now shares "a"'s dirty blocks. */
+  writes = cache_stat (WRITE);
+  seek (b_fd, 0);
+  CHECK (write (b_fd, a_buf, BUF_SIZE) == BUF_SIZE,
+         "rewrite \"b\" with the contents of \"a\"");
+  CHECK (fsync (b_fd), "fsync \"b\"");
+  CHECK (cache_stat (WRITE) >= writes + BLOCK_CNT,
+         "shared blocks were written");
+
+  /* Block 0 of "b" moves to block 1 of "a". */
+  seek (b_fd, 0);
+  CHECK (write (b_fd, a_buf + BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE)
+         == BLOCK_SECTOR_SIZE, "rewrite one block of \"b\"");
+  writes = cache_stat (WRITE);
+  CHECK (fdatasync (b_fd), "fdatasync \"b\"");
+  CHECK (cache_stat (WRITE) > writes, "block map was written");
+
+  memcpy (check, a_buf, BUF_SIZE);
+  memcpy (check, a_buf + BLOCK_SECTOR_SIZE, BLOCK_SECTOR_SIZE);
+  seek (b_fd, 0);
+  CHECK (read (b_fd, b_buf, BUF_SIZE) == BUF_SIZE
+         && !memcmp (b_buf, check, BUF_SIZE), "read back \"b\"");
+  seek (a_fd, 0);
+  CHECK (read (a_fd, b_buf, BUF_SIZE) == BUF_SIZE
+         && !memcmp (b_buf, a_buf, BUF_SIZE), "read back \"a\"");
+
+  msg ("close \"a\"");
+  close (a_fd);
+  msg ("close \"b\"");
+  close (b_fd);
+  remove ("a");
+  remove ("b");
+}
@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fsync-dedup) begin
+(fsync-dedup) create "b"
+(fsync-dedup) open "b"
+(fsync-dedup) write 2048 bytes to "b"
+(fsync-dedup) fsync "b"
+(fsync-dedup) create "a"
+(fsync-dedup) open "a"
+(fsync-dedup) write 2048 bytes to "a"
+(fsync-dedup) rewrite "b" with the contents of "a"
+(fsync-dedup) fsync "b"
+(fsync-dedup) shared blocks were written
+(fsync-dedup) rewrite one block of "b"
+(fsync-dedup) fdatasync "b"
+(fsync-dedup) block map was written
+(fsync-dedup) read back "b"
+(fsync-dedup) read back "a"
+(fsync-dedup) close "a"
+(fsync-dedup) close "b"
+(fsync-dedup) end
+EOF
+pass;
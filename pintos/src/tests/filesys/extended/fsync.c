@@ -0,0 +1,50 @@
+/* Writes a file and syncs it, then checks that fdatasync() on
+   the clean file writes nothing and that after rewriting one
+   block in place it writes exactly that block. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define BLOCK_SECTOR_SIZE 512
+#define BUF_SIZE (BLOCK_SECTOR_SIZE * 8)
+
+/* From cache.h */
+#define WRITE 3
+
+static char buf[BUF_SIZE];
+
+void
+test_main (void)
+{
+  int test_fd;
+  char *file_name = "a";
+  long long writes;
+
+  CHECK (create (file_name, 0), "create \"%s\"", file_name);
+  CHECK ((test_fd = open (file_name)) > 1, "open \"%s\"", file_name);
+
+  random_bytes (buf, sizeof buf);
+  CHECK (write (test_fd, buf, sizeof buf) == BUF_SIZE,
+         "write %d bytes to \"%s\"", (int) BUF_SIZE, file_name);
+  CHECK (fsync (test_fd), "fsync \"%s\"", file_name);
+
+  writes = cache_stat (WRITE);
+  CHECK (fdatasync (test_fd), "fdatasync \"%s\"", file_name);
+  CHECK (cache_stat (WRITE) == writes, "clean file needs no writes");
+
+  seek (test_fd, BLOCK_SECTOR_SIZE * 3);
+  CHECK (write (test_fd, buf, BLOCK_SECTOR_SIZE) == BLOCK_SECTOR_SIZE,
+         "rewrite one block of \"%s\"", file_name);
+  writes = cache_stat (WRITE);
+  CHECK (fdatasync (test_fd), "fdatasync \"%s\"", file_name);
+  CHECK (cache_stat (WRITE) == writes + 1, "wrote one block");
+
+  CHECK (!fsync (STDOUT_FILENO), "fsync console fails");
+
+  msg ("close \"%s\"", file_name);
+  close (test_fd);
+  remove (file_name);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fsync) begin
+(fsync) create "a"
+(fsync) open "a"
+(fsync) write 4096 bytes to "a"
+(fsync) fsync "a"
+(fsync) fdatasync "a"
+(fsync) clean file needs no writes
+(fsync) rewrite one block of "a"
+(fsync) fdatasync "a"
+(fsync) wrote one block
+(fsync) fsync console fails
+(fsync) close "a"
+(fsync) end
+EOF
+pass;
@@ -0,0 +1,53 @@
+/* Runs with -no-checkpoint, so that the metadata written here
+   reaches its home sectors only when the persistence run replays
+   the journal.  Creates a directory of files, whose inodes and
+   entries are logged, then removes them and writes a file over
+   the sectors they freed, so that replay must honor the
+   revocation of those sectors too. */
+
+#include <random.h>
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 4
+#define DATA_SIZE 8192
+
+static char buf[DATA_SIZE];
+
+void
+test_main (void)
+{
+  char name[16];
+  int fd, i;
+
+  random_init (0);
+  random_bytes (buf, sizeof buf);
+
+  CHECK (create ("data", 0), "create \"data\"");
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+
+  CHECK (mkdir ("d"), "mkdir \"d\"");
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "d/f%d", i);
+      CHECK (create (name, 0), "create \"%s\"", name);
+    }
+  CHECK (fsync (fd), "fsync \"data\"");
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "d/f%d", i);
+      CHECK (remove (name), "remove \"%s\"", name);
+    }
+  CHECK (remove ("d"), "remove \"d\"");
+
+  CHECK (write (fd, buf, DATA_SIZE) == DATA_SIZE,
+         "write %d bytes to \"data\"", DATA_SIZE);
+  CHECK (fsync (fd), "fsync \"data\"");
+  msg ("close \"data\"");
+  close (fd);
+
+  check_file ("data", buf, DATA_SIZE);
+}
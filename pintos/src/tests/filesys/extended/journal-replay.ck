@@ -0,0 +1,28 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(journal-replay) begin
+(journal-replay) create "data"
+(journal-replay) open "data"
+(journal-replay) mkdir "d"
+(journal-replay) create "d/f0"
+(journal-replay) create "d/f1"
+(journal-replay) create "d/f2"
+(journal-replay) create "d/f3"
+(journal-replay) fsync "data"
+(journal-replay) remove "d/f0"
+(journal-replay) remove "d/f1"
+(journal-replay) remove "d/f2"
+(journal-replay) remove "d/f3"
+(journal-replay) remove "d"
+(journal-replay) write 8192 bytes to "data"
+(journal-replay) fsync "data"
+(journal-replay) close "data"
+(journal-replay) open "data" for verification
+(journal-replay) verified contents of "data"
+(journal-replay) close "data"
+(journal-replay) end
+EOF
+pass;
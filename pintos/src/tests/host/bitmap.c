@@ -0,0 +1,199 @@
+/* Tests and benchmarks for lib/kernel/bitmap.c.
+
+   Checks bitmap_count(), bitmap_contains(), bitmap_scan() and
+   bitmap_set_multiple() against bit-at-a-time reference versions
+   built on bitmap_test() and bitmap_set(), and times both on
+   large bitmaps with a range of fill densities. */
+
+#include "tests/host/host.h"
+#include <random.h>
+#include <stdio.h>
+#include "lib/kernel/bitmap.h"
+
+/* Reference implementations, one bit at a time. */
+
+static size_t
+ref_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t i, value_cnt = 0;
+
+  for (i = 0; i < cnt; i++)
+    if (bitmap_test (b, start + i) == value)
+      value_cnt++;
+  return value_cnt;
+}
+
+static bool
+ref_contains (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    if (bitmap_test (b, start + i) == value)
+      return true;
+  return false;
+}
+
+static size_t
+ref_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t size = bitmap_size (b);
+
+  if (cnt <= size)
+    {
+      size_t last = size - cnt;
+      size_t i;
+      for (i = start; i <= last; i++)
+        if (!ref_contains (b, i, cnt, !value))
+          return i;
+    }
+  return BITMAP_ERROR;
+}
+
+static void
+ref_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    bitmap_set (b, start + i, value);
+}
+
+/* Fills B so that each bit is set with probability PERCENT%,
+   in runs of RUN bits. */
+static void
+fill (struct bitmap *b, int percent, size_t run)
+{
+  size_t size = bitmap_size (b);
+  size_t i;
+
+  for (i = 0; i < size; i += run)
+    {
+      size_t cnt = i + run <= size ? run : size - i;
+      ref_set_multiple (b, i, cnt, random_upto (99) < (size_t) percent);
+    }
+}
+
+/* Checks the word-level operations against the references on
+   randomly filled bitmaps of many sizes. */
+void
+test_bitmap (void)
+{
+  int round;
+
+  for (round = 0; round < 2000; round++)
+    {
+      size_t size = random_upto (300);
+      struct bitmap *b = bitmap_create (size);
+      struct bitmap *r = bitmap_create (size);
+      int op;
+
+      if (!CHECK (b != NULL && r != NULL, "out of memory"))
+        return;
+      fill (b, random_upto (100), 1 + random_upto (40));
+      for (op = 0; op < 50; op++)
+        {
+          size_t start = random_upto (size);
+          size_t cnt = random_upto (size - start);
+          bool value = random_ulong () & 1;
+          size_t i;
+
+          CHECK (bitmap_count (b, start, cnt, value)
+                 == ref_count (b, start, cnt, value),
+                 "bitmap_count (%zu, %zu, %d)", start, cnt, value);
+          CHECK (bitmap_contains (b, start, cnt, value)
+                 == ref_contains (b, start, cnt, value),
+                 "bitmap_contains (%zu, %zu, %d)", start, cnt, value);
+          CHECK (bitmap_scan (b, start, cnt % 70, value)
+                 == ref_scan (b, start, cnt % 70, value),
+                 "bitmap_scan (%zu, %zu, %d)", start, cnt % 70, value);
+
+          for (i = 0; i < size; i++)
+            bitmap_set (r, i, bitmap_test (b, i));
+          bitmap_set_multiple (b, start, cnt, value);
+          ref_set_multiple (r, start, cnt, value);
+          for (i = 0; i < size; i++)
+            if (!CHECK (bitmap_test (b, i) == bitmap_test (r, i),
+                        "bitmap_set_multiple (%zu, %zu, %d), bit %zu",
+                        start, cnt, value, i))
+              break;
+        }
+      bitmap_destroy (b);
+      bitmap_destroy (r);
+    }
+}
+
+/* Keeps results alive so the compiler cannot discard the calls. */
+static volatile size_t sink;
+
+/* Times ITERATIONS evaluations each of WORD and BIT, which
+   perform the same operation described by NAME, and reports the
+   cycles per call of each. */
+#define BENCH(NAME, ITERATIONS, WORD, BIT)                              \
+        do {                                                            \
+          uint64_t start;                                               \
+          int it_;                                                      \
+          start = rdtsc ();                                             \
+          for (it_ = 0; it_ < (ITERATIONS); it_++)                      \
+            sink += (size_t) (WORD);                                    \
+          bench_report (NAME " (word)", rdtsc () - start, ITERATIONS);  \
+          start = rdtsc ();                                             \
+          for (it_ = 0; it_ < (ITERATIONS); it_++)                      \
+            sink += (size_t) (BIT);                                     \
+          bench_report (NAME " (bit)", rdtsc () - start, ITERATIONS);   \
+        } while (0)
+
+static size_t
+do_set_multiple (struct bitmap *b, size_t cnt, bool value)
+{
+  bitmap_set_multiple (b, 0, cnt, value);
+  return 0;
+}
+
+static size_t
+do_ref_set_multiple (struct bitmap *b, size_t cnt, bool value)
+{
+  ref_set_multiple (b, 0, cnt, value);
+  return 0;
+}
+
+/* Times word-level and bit-at-a-time operations on a bitmap of
+   1M bits. */
+void
+bench_bitmap (void)
+{
+  static const int densities[] = {0, 50, 99, 100};
+  size_t bits = 1 << 20;
+  struct bitmap *b;
+  size_t i;
+
+  b = bitmap_create (bits);
+  if (!CHECK (b != NULL, "out of memory"))
+    return;
+
+  for (i = 0; i < sizeof densities / sizeof *densities; i++)
+    {
+      bitmap_set_all (b, false);
+      fill (b, densities[i], 8);
+      printf ("%zu bits, %d%% set:\n", bits, densities[i]);
+      BENCH ("count", 10,
+             bitmap_count (b, 0, bits, true),
+             ref_count (b, 0, bits, true));
+      BENCH ("contains", 10,
+             bitmap_contains (b, 1, bits - 1, false),
+             ref_contains (b, 1, bits - 1, false));
+      BENCH ("scan 1 clear", 10,
+             bitmap_scan (b, 0, 1, false),
+             ref_scan (b, 0, 1, false));
+      BENCH ("scan 64 clear", 10,
+             bitmap_scan (b, 0, 64, false),
+             ref_scan (b, 0, 64, false));
+    }
+
+  printf ("%zu bits:\n", bits);
+  BENCH ("set_multiple", 10,
+         do_set_multiple (b, bits, true),
+         do_ref_set_multiple (b, bits, true));
+
+  bitmap_destroy (b);
+}
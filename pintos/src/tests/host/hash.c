@@ -0,0 +1,238 @@
+/* Tests and benchmarks for lib/kernel/hash.c and
+   lib/kernel/ohash.c.
+
+   Runs a random mix of insertions, replacements, deletions and
+   lookups on both kinds of table and checks that they agree,
+   then times insertion, successful and failing lookups, and
+   deletion of many integer keys in each. */
+
+#include "tests/host/host.h"
+#include <random.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "lib/kernel/hash.h"
+#include "lib/kernel/ohash.h"
+
+/* An element that can be in both kinds of table at once. */
+struct item
+  {
+    int key;
+    struct hash_elem h_elem;
+    struct ohash_elem o_elem;
+  };
+
+static unsigned
+item_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct item, h_elem)->key);
+}
+
+static bool
+item_less (const struct hash_elem *a, const struct hash_elem *b,
+           void *aux UNUSED)
+{
+  return (hash_entry (a, struct item, h_elem)->key
+          < hash_entry (b, struct item, h_elem)->key);
+}
+
+static unsigned
+item_ohash (const struct ohash_elem *e, void *aux UNUSED)
+{
+  return hash_int (ohash_entry (e, struct item, o_elem)->key);
+}
+
+static bool
+item_oless (const struct ohash_elem *a, const struct ohash_elem *b,
+            void *aux UNUSED)
+{
+  return (ohash_entry (a, struct item, o_elem)->key
+          < ohash_entry (b, struct item, o_elem)->key);
+}
+
+/* Converts hash elements, possibly null, to items. */
+static struct item *
+h_item (struct hash_elem *e)
+{
+  return e != NULL ? hash_entry (e, struct item, h_elem) : NULL;
+}
+
+static struct item *
+o_item (struct ohash_elem *e)
+{
+  return e != NULL ? ohash_entry (e, struct item, o_elem) : NULL;
+}
+
+/* Returns the item in H with KEY, or a null pointer. */
+static struct item *
+h_find (struct hash *h, int key)
+{
+  struct item probe;
+
+  probe.key = key;
+  return h_item (hash_find (h, &probe.h_elem));
+}
+
+/* Returns the item in O with KEY, or a null pointer. */
+static struct item *
+o_find (struct ohash *o, int key)
+{
+  struct item probe;
+
+  probe.key = key;
+  return o_item (ohash_find (o, &probe.o_elem));
+}
+
+/* Runs random operations on both tables and checks that they
+   agree, including on what iteration returns. */
+void
+test_hash (void)
+{
+  enum { KEYS = 3000, OPS = 400000 };
+  static struct item items[2][KEYS];
+  struct ohash_iterator i;
+  struct hash h;
+  struct ohash o;
+  size_t iterated;
+  int op;
+
+  if (!CHECK (hash_init (&h, item_hash, item_less, NULL)
+              && ohash_init (&o, item_ohash, item_oless, NULL),
+              "out of memory"))
+    return;
+
+  for (op = 0; op < OPS; op++)
+    {
+      /* Drift between growing and shrinking phases. */
+      int key = random_upto ((op / 50000 % 2 ? KEYS : KEYS / 20) - 1);
+      struct item *it = &items[random_ulong () & 1][key];
+
+      it->key = key;
+      switch (random_upto (3))
+        {
+        case 0:
+          if (h_find (&h, key) != NULL)
+            break;
+          CHECK ((hash_insert (&h, &it->h_elem) == NULL)
+                 == (ohash_insert (&o, &it->o_elem) == NULL),
+                 "insert %d", key);
+          break;
+
+        case 1:
+          CHECK (h_item (hash_replace (&h, &it->h_elem))
+                 == o_item (ohash_replace (&o, &it->o_elem)),
+                 "replace %d", key);
+          break;
+
+        case 2:
+          CHECK (h_item (hash_delete (&h, &it->h_elem))
+                 == o_item (ohash_delete (&o, &it->o_elem)),
+                 "delete %d", key);
+          break;
+
+        case 3:
+          CHECK (h_find (&h, key) == o_find (&o, key), "find %d", key);
+          break;
+        }
+      if (!CHECK (hash_size (&h) == ohash_size (&o),
+                  "size %zu != %zu", hash_size (&h), ohash_size (&o)))
+        break;
+    }
+
+  /* Every element must come out of iteration exactly once. */
+  iterated = 0;
+  ohash_first (&i, &o);
+  while (ohash_next (&i))
+    {
+      struct item *it = o_item (ohash_cur (&i));
+      CHECK (h_find (&h, it->key) == it, "iteration returned %d", it->key);
+      iterated++;
+    }
+  CHECK (iterated == hash_size (&h),
+         "iterated over %zu of %zu elements", iterated, hash_size (&h));
+
+  hash_destroy (&h, NULL);
+  ohash_destroy (&o, NULL);
+}
+
+/* Times each operation over 1M keys in both tables. */
+void
+bench_hash (void)
+{
+  size_t n = 1 << 20;
+  struct item *items, *probes;
+  struct hash h;
+  struct ohash o;
+  uint64_t start;
+  size_t found;
+  size_t i;
+
+  /* Lookups happen in shuffled order, so that neither table
+     benefits from allocation order. */
+  items = malloc (n * sizeof *items);
+  probes = malloc (n * sizeof *probes);
+  if (!CHECK (items != NULL && probes != NULL
+              && hash_init (&h, item_hash, item_less, NULL)
+              && ohash_init (&o, item_ohash, item_oless, NULL),
+              "out of memory"))
+    return;
+  for (i = 0; i < n; i++)
+    items[i].key = probes[i].key = (int) i * 2;
+  for (i = n; i > 1; i--)
+    {
+      size_t j = random_upto (i - 1);
+      int key = probes[i - 1].key;
+      probes[i - 1].key = probes[j].key;
+      probes[j].key = key;
+    }
+  printf ("%zu elements:\n", n);
+
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    hash_insert (&h, &items[i].h_elem);
+  bench_report ("insert (hash)", rdtsc () - start, n);
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    ohash_insert (&o, &items[i].o_elem);
+  bench_report ("insert (ohash)", rdtsc () - start, n);
+
+  found = 0;
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    found += hash_find (&h, &probes[i].h_elem) != NULL;
+  bench_report ("find hit (hash)", rdtsc () - start, n);
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    found += ohash_find (&o, &probes[i].o_elem) != NULL;
+  bench_report ("find hit (ohash)", rdtsc () - start, n);
+  CHECK (found == 2 * n, "found %zu of %zu", found, 2 * n);
+
+  for (i = 0; i < n; i++)
+    probes[i].key++;
+  found = 0;
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    found += hash_find (&h, &probes[i].h_elem) != NULL;
+  bench_report ("find miss (hash)", rdtsc () - start, n);
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    found += ohash_find (&o, &probes[i].o_elem) != NULL;
+  bench_report ("find miss (ohash)", rdtsc () - start, n);
+  CHECK (found == 0, "found %zu absent keys", found);
+
+  for (i = 0; i < n; i++)
+    probes[i].key--;
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    hash_delete (&h, &probes[i].h_elem);
+  bench_report ("delete (hash)", rdtsc () - start, n);
+  start = rdtsc ();
+  for (i = 0; i < n; i++)
+    ohash_delete (&o, &probes[i].o_elem);
+  bench_report ("delete (ohash)", rdtsc () - start, n);
+  CHECK (hash_empty (&h) && ohash_empty (&o), "tables not empty");
+
+  hash_destroy (&h, NULL);
+  ohash_destroy (&o, NULL);
+  free (items);
+  free (probes);
+}
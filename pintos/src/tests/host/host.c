@@ -0,0 +1,250 @@
+/* Freestanding runtime for the host test harness: program entry,
+   Linux system calls, console output, memory allocation, and
+   panics.  See host.h. */
+
+#include "tests/host/host.h"
+#include <random.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main (int argc, char *argv[]);
+void host_start (int argc, char *argv[]) NO_RETURN;
+
+/* Linux i386 system call numbers. */
+#define LINUX_EXIT 1
+#define LINUX_WRITE 4
+
+/* Program entry point.  Linux leaves ARGC at the top of the
+   stack, followed by the ARGV array. */
+asm (".globl _start\n"
+     "_start:\n"
+     "\txorl %ebp, %ebp\n"
+     "\tmovl (%esp), %eax\n"
+     "\tleal 4(%esp), %ecx\n"
+     "\tandl $-16, %esp\n"
+     "\tsubl $8, %esp\n"
+     "\tpushl %ecx\n"
+     "\tpushl %eax\n"
+     "\tcall host_start\n");
+
+/* Console output buffer, flushed at each new-line. */
+static char out_buf[4096];
+static size_t out_cnt;
+
+static void
+flush (void)
+{
+  host_write (STDOUT_FILENO, out_buf, out_cnt);
+  out_cnt = 0;
+}
+
+/* Runs main() and exits with its return value. */
+void
+host_start (int argc, char *argv[])
+{
+  random_init (0);
+  host_exit (main (argc, argv));
+}
+
+/* Writes SIZE bytes from BUF to file descriptor FD. */
+void
+host_write (int fd, const void *buf, size_t size)
+{
+  int retval;
+
+  asm volatile ("int $0x80"
+                : "=a" (retval)
+                : "0" (LINUX_WRITE), "b" (fd), "c" (buf), "d" (size)
+                : "memory");
+}
+
+/* Flushes console output and exits with STATUS. */
+void
+host_exit (int status)
+{
+  flush ();
+  asm volatile ("int $0x80" : : "a" (LINUX_EXIT), "b" (status));
+  NOT_REACHED ();
+}
+
+/* Console. */
+
+/* Writes C to the console. */
+int
+putchar (int c)
+{
+  out_buf[out_cnt++] = c;
+  if (c == '\n' || out_cnt >= sizeof out_buf)
+    flush ();
+  return c;
+}
+
+/* Writes string S to the console, followed by a new-line
+   character. */
+int
+puts (const char *s)
+{
+  while (*s != '\0')
+    putchar (*s++);
+  putchar ('\n');
+  return 0;
+}
+
+static void
+vprintf_helper (char c, void *char_cnt)
+{
+  putchar (c);
+  ++*(int *) char_cnt;
+}
+
+/* The standard vprintf() function,
+   which is like printf() but uses a va_list. */
+int
+vprintf (const char *format, va_list args)
+{
+  int char_cnt = 0;
+  __vprintf (format, args, vprintf_helper, &char_cnt);
+  return char_cnt;
+}
+
+/* Panics.  In a host test, a panic is a failed assertion that
+   ends the run. */
+void
+debug_panic (const char *file, int line, const char *function,
+             const char *message, ...)
+{
+  va_list args;
+
+  printf ("PANIC at %s:%d in %s(): ", file, line, function);
+  va_start (args, message);
+  vprintf (message, args);
+  printf ("\n");
+  va_end (args);
+  host_exit (2);
+}
+
+/* Memory allocation.
+
+   A bump allocator over a large zero-initialized arena, which
+   the host only backs with memory as it is touched.  Freed
+   memory is never reused, which is fine for short test runs and
+   keeps allocator behavior out of the measurements. */
+
+#define ARENA_SIZE (512 * 1024 * 1024)
+
+static uint8_t arena[ARENA_SIZE] __attribute__ ((aligned (16)));
+static size_t arena_used;
+
+/* Header in front of each block. */
+struct block
+  {
+    size_t size;                /* Usable size in bytes. */
+    size_t pad[3];              /* Keeps blocks 16-byte aligned. */
+  };
+
+void *
+malloc (size_t size)
+{
+  struct block *b;
+  size_t need = sizeof *b + ((size + 15) & ~15u);
+
+  if (size > ARENA_SIZE || need > ARENA_SIZE - arena_used)
+    return NULL;
+  b = (struct block *) (arena + arena_used);
+  arena_used += need;
+  b->size = size;
+  return b + 1;
+}
+
+void *
+calloc (size_t a, size_t b)
+{
+  void *p;
+  size_t size = a * b;
+
+  if (size < a || size < b)
+    return NULL;
+  p = malloc (size);
+  if (p != NULL)
+    memset (p, 0, size);
+  return p;
+}
+
+void *
+realloc (void *old, size_t new_size)
+{
+  void *new;
+
+  if (new_size == 0)
+    {
+      free (old);
+      return NULL;
+    }
+  new = malloc (new_size);
+  if (new != NULL && old != NULL)
+    {
+      struct block *b = (struct block *) old - 1;
+      memcpy (new, old, b->size < new_size ? b->size : new_size);
+      free (old);
+    }
+  return new;
+}
+
+void
+free (void *p UNUSED)
+{
+}
+
+/* Checks and measurements. */
+
+static int check_cnt;
+static int fail_cnt;
+
+/* Records the outcome of a check made at FILE:LINE.  If it
+   failed, prints the message formatted from FORMAT.  Returns
+   SUCCESS. */
+bool
+check (bool success, const char *file, int line, const char *format, ...)
+{
+  check_cnt++;
+  if (!success)
+    {
+      va_list args;
+
+      fail_cnt++;
+      printf ("FAIL %s:%d: ", file, line);
+      va_start (args, format);
+      vprintf (format, args);
+      va_end (args);
+      printf ("\n");
+    }
+  return success;
+}
+
+/* Returns the number of failed checks, after printing a summary
+   of all checks made so far. */
+int
+check_summary (void)
+{
+  printf ("%d checks, %d failed\n", check_cnt, fail_cnt);
+  return fail_cnt;
+}
+
+/* Prints CYCLES spent on OP_CNT operations named NAME, per
+   operation, with two decimal places. */
+void
+bench_report (const char *name, uint64_t cycles, size_t op_cnt)
+{
+  uint64_t centi = op_cnt > 0 ? cycles * 100 / op_cnt : 0;
+  printf ("  %-32s %10llu.%02llu cycles/op\n",
+          name, centi / 100, centi % 100);
+}
+
+/* Returns a pseudo-random number between 0 and N, inclusive. */
+size_t
+random_upto (size_t n)
+{
+  return n < SIZE_MAX ? random_ulong () % (n + 1) : random_ulong ();
+}
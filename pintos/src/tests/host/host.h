@@ -0,0 +1,60 @@
+#ifndef TESTS_HOST_HOST_H
+#define TESTS_HOST_HOST_H
+
+/* Host-native test and benchmark harness for lib and lib/kernel.
+
+   The library sources are compiled as 32-bit code, with the
+   Pintos headers, exactly as for the kernel and user programs,
+   and linked into a freestanding Linux executable that supplies
+   the few services they need (console output, memory
+   allocation, panics) itself.  No host C library is involved,
+   so Pintos's own printf(), memcpy(), qsort() and so on are the
+   ones that run. */
+
+#include <debug.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* A test or benchmark suite. */
+typedef void suite_func (void);
+
+extern suite_func test_list;
+extern suite_func bench_list;
+extern suite_func test_hash;
+extern suite_func bench_hash;
+extern suite_func test_bitmap;
+extern suite_func bench_bitmap;
+extern suite_func test_string;
+extern suite_func bench_string;
+extern suite_func test_stdlib;
+extern suite_func bench_stdlib;
+extern suite_func test_stdio;
+extern suite_func bench_stdio;
+
+/* Checks that CONDITION holds, reporting a failure with the
+   printf()-style message that follows if not.  Evaluates to
+   CONDITION. */
+#define CHECK(CONDITION, ...) \
+        check ((CONDITION), __FILE__, __LINE__, __VA_ARGS__)
+bool check (bool, const char *file, int line, const char *format, ...)
+  PRINTF_FORMAT (4, 5);
+int check_summary (void);
+
+void bench_report (const char *name, uint64_t cycles, size_t op_cnt);
+size_t random_upto (size_t n);
+
+/* Host services. */
+void host_write (int fd, const void *, size_t);
+void host_exit (int status) NO_RETURN;
+
+/* Returns the time-stamp counter. */
+static inline uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+#endif /* tests/host/host.h */
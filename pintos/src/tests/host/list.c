@@ -0,0 +1,174 @@
+/* Tests and benchmarks for lib/kernel/list.c.
+
+   Checks insertion, removal, reversal, sorting, ordered
+   insertion and duplicate removal against a plain array holding
+   the same values, and times sorting and queue operations. */
+
+#include "tests/host/host.h"
+#include <random.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "lib/kernel/list.h"
+
+/* A list element holding a value. */
+struct value
+  {
+    struct list_elem elem;
+    int value;
+  };
+
+static bool
+value_less (const struct list_elem *a, const struct list_elem *b,
+            void *aux UNUSED)
+{
+  return (list_entry (a, struct value, elem)->value
+          < list_entry (b, struct value, elem)->value);
+}
+
+/* Returns true if LIST holds exactly the CNT values in ARRAY, in
+   order, checking the backward links as well as the forward
+   ones. */
+static bool
+list_matches (struct list *list, const int *array, size_t cnt)
+{
+  struct list_elem *e;
+  size_t i;
+
+  if (list_size (list) != cnt)
+    return false;
+  for (e = list_begin (list), i = 0; e != list_end (list);
+       e = list_next (e), i++)
+    if (list_entry (e, struct value, elem)->value != array[i])
+      return false;
+  for (e = list_rbegin (list); e != list_rend (list); e = list_prev (e))
+    if (list_entry (e, struct value, elem)->value != array[--i])
+      return false;
+  return true;
+}
+
+static int
+compare_ints (const void *a_, const void *b_)
+{
+  const int *a = a_, *b = b_;
+  return *a < *b ? -1 : *a > *b;
+}
+
+void
+test_list (void)
+{
+  enum { MAX_CNT = 64 };
+  static struct value values[MAX_CNT];
+  int expected[MAX_CNT];
+  int round;
+
+  for (round = 0; round < 500; round++)
+    {
+      size_t cnt = random_upto (MAX_CNT);
+      struct list list, dups;
+      struct list_elem *e;
+      size_t i, j;
+
+      /* Fill with values pushed alternately at both ends. */
+      list_init (&list);
+      for (i = 0; i < cnt; i++)
+        values[i].value = random_upto (cnt / 2);
+      for (i = 0; i < cnt; i++)
+        if (i % 2)
+          list_push_back (&list, &values[i].elem);
+        else
+          list_push_front (&list, &values[i].elem);
+      for (i = 0, j = cnt; j-- > 0; )
+        if (j % 2 == 0)
+          expected[i++] = values[j].value;
+      for (j = 0; j < cnt; j++)
+        if (j % 2)
+          expected[i++] = values[j].value;
+      CHECK (list_matches (&list, expected, cnt), "push, %zu elements", cnt);
+
+      /* Reverse. */
+      list_reverse (&list);
+      for (i = 0; i < cnt / 2; i++)
+        {
+          int tmp = expected[i];
+          expected[i] = expected[cnt - i - 1];
+          expected[cnt - i - 1] = tmp;
+        }
+      CHECK (list_matches (&list, expected, cnt),
+             "reverse, %zu elements", cnt);
+
+      /* Sort. */
+      list_sort (&list, value_less, NULL);
+      qsort (expected, cnt, sizeof *expected, compare_ints);
+      CHECK (list_matches (&list, expected, cnt), "sort, %zu elements", cnt);
+
+      /* Minimum and maximum. */
+      if (cnt > 0)
+        {
+          CHECK (list_entry (list_min (&list, value_less, NULL),
+                             struct value, elem)->value == expected[0],
+                 "min, %zu elements", cnt);
+          CHECK (list_entry (list_max (&list, value_less, NULL),
+                             struct value, elem)->value == expected[cnt - 1],
+                 "max, %zu elements", cnt);
+        }
+
+      /* Remove duplicates. */
+      list_init (&dups);
+      list_unique (&list, &dups, value_less, NULL);
+      for (i = j = 0; i < cnt; i++)
+        if (i == 0 || expected[i] != expected[i - 1])
+          expected[j++] = expected[i];
+      CHECK (list_matches (&list, expected, j), "unique, %zu elements", cnt);
+      CHECK (list_size (&dups) == cnt - j, "unique left %zu duplicates",
+             list_size (&dups));
+
+      /* Put the duplicates back in order. */
+      while (!list_empty (&dups))
+        list_insert_ordered (&list, list_pop_front (&dups),
+                             value_less, NULL);
+      CHECK (list_size (&list) == cnt, "insert_ordered, %zu elements", cnt);
+      for (e = list_begin (&list); e != list_end (&list); e = list_next (e))
+        if (list_next (e) != list_end (&list)
+            && !CHECK (!value_less (list_next (e), e, NULL),
+                       "insert_ordered, %zu elements", cnt))
+          break;
+    }
+}
+
+void
+bench_list (void)
+{
+  enum { CNT = 100000 };
+  struct value *values = malloc (CNT * sizeof *values);
+  struct list list;
+  uint64_t start;
+  size_t i;
+
+  if (!CHECK (values != NULL, "out of memory"))
+    return;
+
+  list_init (&list);
+  for (i = 0; i < CNT; i++)
+    {
+      values[i].value = random_ulong ();
+      list_push_back (&list, &values[i].elem);
+    }
+  start = rdtsc ();
+  list_sort (&list, value_less, NULL);
+  bench_report ("sort 100000 random", rdtsc () - start, CNT);
+  start = rdtsc ();
+  list_sort (&list, value_less, NULL);
+  bench_report ("sort 100000 sorted", rdtsc () - start, CNT);
+
+  start = rdtsc ();
+  for (i = 0; i < CNT; i++)
+    list_push_back (&list, list_pop_front (&list));
+  bench_report ("pop_front + push_back", rdtsc () - start, CNT);
+
+  start = rdtsc ();
+  i = list_size (&list);
+  bench_report ("size of 100000", rdtsc () - start, 1);
+  CHECK (i == CNT, "list_size returned %zu", i);
+
+  free (values);
+}
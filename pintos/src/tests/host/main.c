@@ -0,0 +1,76 @@
+/* libtest: runs the host-native tests, and optionally the
+   benchmarks, for lib and lib/kernel.
+
+   Usage: libtest [-b] [SUITE...]
+   where SUITE is one of the names in the table below.  Without
+   any SUITE, runs them all.  With -b, runs each suite's
+   benchmarks after its tests. */
+
+#include "tests/host/host.h"
+#include <stdio.h>
+#include <string.h>
+
+struct suite
+  {
+    const char *name;
+    suite_func *test;
+    suite_func *bench;
+  };
+
+static const struct suite suites[] =
+  {
+    {"list", test_list, bench_list},
+    {"hash", test_hash, bench_hash},
+    {"bitmap", test_bitmap, bench_bitmap},
+    {"string", test_string, bench_string},
+    {"stdlib", test_stdlib, bench_stdlib},
+    {"stdio", test_stdio, bench_stdio},
+  };
+#define SUITE_CNT (sizeof suites / sizeof *suites)
+
+/* Runs suite S, with its benchmarks if BENCH. */
+static void
+run_suite (const struct suite *s, bool bench)
+{
+  printf ("%s: tests\n", s->name);
+  s->test ();
+  if (bench)
+    {
+      printf ("%s: benchmarks\n", s->name);
+      s->bench ();
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool bench = false;
+  const struct suite *s;
+  int i;
+
+  if (argc > 1 && !strcmp (argv[1], "-b"))
+    {
+      bench = true;
+      argc--;
+      argv++;
+    }
+
+  if (argc <= 1)
+    for (s = suites; s < suites + SUITE_CNT; s++)
+      run_suite (s, bench);
+  else
+    for (i = 1; i < argc; i++)
+      {
+        for (s = suites; s < suites + SUITE_CNT; s++)
+          if (!strcmp (argv[i], s->name))
+            break;
+        if (s >= suites + SUITE_CNT)
+          {
+            printf ("libtest: no suite named \"%s\"\n", argv[i]);
+            return 2;
+          }
+        run_suite (s, bench);
+      }
+
+  return check_summary () == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+/* Tests and benchmarks for lib/stdio.c.
+
+   Checks snprintf() formatting of each conversion, flag, width,
+   precision and length modifier against expected strings, and
+   times common formats. */
+
+#include "tests/host/host.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Checks that formatting FORMAT with the arguments that follow
+   yields EXPECTED. */
+#define CHECK_FORMAT(EXPECTED, FORMAT, ...)                             \
+        do {                                                            \
+          char buf_[128];                                               \
+          int len_ = snprintf (buf_, sizeof buf_, FORMAT, __VA_ARGS__); \
+          CHECK (!strcmp (buf_, EXPECTED)                               \
+                 && len_ == (int) strlen (EXPECTED),                    \
+                 "snprintf (\"%s\") produced \"%s\", expected \"%s\"",  \
+                 FORMAT, buf_, EXPECTED);                               \
+        } while (0)
+
+void
+test_stdio (void)
+{
+  static char hello[] = "hello, world";
+  char buf[8];
+  int len;
+
+  CHECK_FORMAT ("42", "%d", 42);
+  CHECK_FORMAT ("-42", "%i", -42);
+  CHECK_FORMAT ("4294967295", "%u", 0xffffffffu);
+  CHECK_FORMAT ("ff FF 377", "%x %X %o", 255, 255, 255);
+  CHECK_FORMAT ("0xff 0377", "%#x %#o", 255, 255);
+  CHECK_FORMAT ("[   42][42   ][00042]", "[%5d][%-5d][%05d]", 42, 42, 42);
+  CHECK_FORMAT ("[+42][ 42]", "[%+d][% d]", 42, 42);
+  CHECK_FORMAT ("[  042]", "[%5.3d]", 42);
+  CHECK_FORMAT ("-9223372036854775808", "%lld", (long long) 1 << 63);
+  CHECK_FORMAT ("18446744073709551615", "%llu", ~0ull);
+  CHECK_FORMAT ("123456789abcdef0", "%llx", 0x123456789abcdef0ull);
+  CHECK_FORMAT ("65535 255", "%hu %hhu", 0xffff, 0xff);
+  CHECK_FORMAT ("4294967295", "%zu", (size_t) -1);
+  CHECK_FORMAT ("[abc][  abc][ab ]", "[%s][%5s][%-3.2s]", "abc", "abc", "abc");
+  CHECK_FORMAT ("x%", "%c%%", 'x');
+  CHECK_FORMAT ("0x1000", "%p", (void *) 0x1000);
+  CHECK_FORMAT ("[*    7]", "[%c%*d]", '*', 5, 7);
+
+  /* Truncation still returns the untruncated length. */
+  len = snprintf (buf, sizeof buf, "%s", hello);
+  CHECK (len == 12 && !strcmp (buf, "hello, "), "snprintf truncation");
+  len = snprintf (NULL, 0, "%d", 12345);
+  CHECK (len == 5, "snprintf length only");
+}
+
+void
+bench_stdio (void)
+{
+  enum { ITERATIONS = 100000 };
+  static char text[] = "a fairly long string of text to copy";
+  char buf[128];
+  uint64_t start;
+  int i;
+
+  start = rdtsc ();
+  for (i = 0; i < ITERATIONS; i++)
+    snprintf (buf, sizeof buf, "%d", i);
+  bench_report ("snprintf %d", rdtsc () - start, ITERATIONS);
+
+  start = rdtsc ();
+  for (i = 0; i < ITERATIONS; i++)
+    snprintf (buf, sizeof buf, "%08x %s", i, text);
+  bench_report ("snprintf %08x %s", rdtsc () - start, ITERATIONS);
+
+  start = rdtsc ();
+  for (i = 0; i < ITERATIONS; i++)
+    snprintf (buf, sizeof buf, "%lld", (long long) i * 1000000007);
+  bench_report ("snprintf %lld", rdtsc () - start, ITERATIONS);
+
+  start = rdtsc ();
+  for (i = 0; i < ITERATIONS; i++)
+    snprintf (buf, sizeof buf, "%s", text);
+  bench_report ("snprintf %s (36 bytes)", rdtsc () - start, ITERATIONS);
+}
@@ -0,0 +1,265 @@
+/* Tests and benchmarks for lib/stdlib.c.
+
+   Checks atoi(), and checks that qsort() sorts, and bsearch()
+   finds, arrays of several element sizes and orders, then times
+   qsort() across element sizes, counts and input orders, next to
+   the byte-swapping heapsort that qsort() used to be. */
+
+#include "tests/host/host.h"
+#include <random.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* An element of a given size whose first word is its key. */
+#define ELEM_SIZE_MAX 64
+
+/* Returns the key of the element at P. */
+static int
+key_of (const void *p)
+{
+  int key;
+  memcpy (&key, p, sizeof key);
+  return key;
+}
+
+static int
+compare_keys (const void *a, const void *b)
+{
+  int x = key_of (a), y = key_of (b);
+  return x < y ? -1 : x > y;
+}
+
+/* Input orders for sorting. */
+enum order { RANDOM, SORTED, REVERSED, FEW_KEYS, ORDER_CNT };
+static const char *order_names[ORDER_CNT]
+  = {"random", "sorted", "reversed", "few keys"};
+
+/* Fills ARRAY with CNT elements of SIZE bytes in the given
+   ORDER.  Each element's bytes after its key are derived from
+   the key, so that sorting must move whole elements. */
+static void
+fill (unsigned char *array, size_t cnt, size_t size, enum order order)
+{
+  size_t i, j;
+
+  for (i = 0; i < cnt; i++)
+    {
+      unsigned char *e = array + i * size;
+      int key;
+
+      switch (order)
+        {
+        case RANDOM:
+          key = random_ulong () & 0x7fffffff;
+          break;
+        case SORTED:
+          key = i;
+          break;
+        case REVERSED:
+          key = cnt - i;
+          break;
+        default:
+          key = random_upto (7);
+          break;
+        }
+      memcpy (e, &key, sizeof key);
+      for (j = sizeof key; j < size; j++)
+        e[j] = key + j;
+    }
+}
+
+/* Returns true if ARRAY, with CNT elements of SIZE bytes, is in
+   order and every element is intact. */
+static bool
+is_sorted (const unsigned char *array, size_t cnt, size_t size)
+{
+  size_t i, j;
+
+  for (i = 0; i < cnt; i++)
+    {
+      const unsigned char *e = array + i * size;
+      int key = key_of (e);
+
+      if (i > 0 && key_of (e - size) > key)
+        return false;
+      for (j = sizeof key; j < size; j++)
+        if (e[j] != (unsigned char) (key + j))
+          return false;
+    }
+  return true;
+}
+
+/* Returns the sum of the keys of ARRAY, with CNT elements of
+   SIZE bytes, as a cheap check that sorting permuted it. */
+static uint64_t
+key_sum (const unsigned char *array, size_t cnt, size_t size)
+{
+  uint64_t sum = 0;
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    sum += key_of (array + i * size);
+  return sum;
+}
+
+/* Reference: the heapsort that qsort() used to be, swapping a
+   byte at a time.  Indexes are 1-based. */
+
+static void
+ref_swap (unsigned char *array, size_t a_idx, size_t b_idx, size_t size)
+{
+  unsigned char *a = array + (a_idx - 1) * size;
+  unsigned char *b = array + (b_idx - 1) * size;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      unsigned char t = a[i];
+      a[i] = b[i];
+      b[i] = t;
+    }
+}
+
+static int
+ref_compare (unsigned char *array, size_t a_idx, size_t b_idx, size_t size,
+             int (*compare) (const void *, const void *))
+{
+  return compare (array + (a_idx - 1) * size, array + (b_idx - 1) * size);
+}
+
+static void
+ref_heapify (unsigned char *array, size_t i, size_t cnt, size_t size,
+             int (*compare) (const void *, const void *))
+{
+  for (;;)
+    {
+      size_t left = 2 * i;
+      size_t right = 2 * i + 1;
+      size_t max = i;
+      if (left <= cnt && ref_compare (array, left, max, size, compare) > 0)
+        max = left;
+      if (right <= cnt && ref_compare (array, right, max, size, compare) > 0)
+        max = right;
+      if (max == i)
+        break;
+      ref_swap (array, i, max, size);
+      i = max;
+    }
+}
+
+static void
+ref_heapsort (void *array, size_t cnt, size_t size,
+              int (*compare) (const void *, const void *))
+{
+  size_t i;
+
+  for (i = cnt / 2; i > 0; i--)
+    ref_heapify (array, i, cnt, size, compare);
+  for (i = cnt; i > 1; i--)
+    {
+      ref_swap (array, 1, i, size);
+      ref_heapify (array, 1, i - 1, size, compare);
+    }
+}
+
+void
+test_stdlib (void)
+{
+  static const size_t sizes[] = {4, 8, 12, 7, 64};
+  static unsigned char array[1000 * ELEM_SIZE_MAX];
+  size_t s;
+  int order;
+
+  CHECK (atoi ("0") == 0, "atoi 0");
+  CHECK (atoi ("  -123abc") == -123, "atoi -123");
+  CHECK (atoi ("+42") == 42, "atoi +42");
+  CHECK (atoi ("2147483647") == 2147483647, "atoi INT_MAX");
+  CHECK (atoi ("-2147483648") == (int) 0x80000000, "atoi INT_MIN");
+  CHECK (atoi ("x1") == 0, "atoi garbage");
+
+  for (s = 0; s < sizeof sizes / sizeof *sizes; s++)
+    for (order = 0; order < ORDER_CNT; order++)
+      {
+        size_t size = sizes[s];
+        size_t cnt;
+
+        for (cnt = 0; cnt <= 1000; cnt = cnt < 40 ? cnt + 1 : cnt * 3)
+          {
+            uint64_t sum;
+            size_t i;
+
+            fill (array, cnt, size, order);
+            sum = key_sum (array, cnt, size);
+            qsort (array, cnt, size, compare_keys);
+            if (!CHECK (is_sorted (array, cnt, size)
+                        && key_sum (array, cnt, size) == sum,
+                        "qsort %zu %zu-byte elements, %s",
+                        cnt, size, order_names[order]))
+              continue;
+
+            for (i = 0; i < cnt; i++)
+              {
+                const unsigned char *e = array + i * size;
+                unsigned char *found = bsearch (e, array, cnt, size,
+                                                compare_keys);
+                if (!CHECK (found != NULL && key_of (found) == key_of (e),
+                            "bsearch element %zu of %zu", i, cnt))
+                  break;
+              }
+            if (order == SORTED)
+              {
+                int absent = -1;
+                CHECK (bsearch (&absent, array, cnt, size, compare_keys)
+                       == NULL, "bsearch absent key");
+              }
+          }
+      }
+}
+
+void
+bench_stdlib (void)
+{
+  static const size_t sizes[] = {4, 8, 16, 64};
+  static const size_t counts[] = {100, 10000, 100000};
+  unsigned char *array = malloc (100000 * ELEM_SIZE_MAX);
+  size_t s, c;
+  int order;
+
+  if (!CHECK (array != NULL, "out of memory"))
+    return;
+
+  for (s = 0; s < sizeof sizes / sizeof *sizes; s++)
+    for (c = 0; c < sizeof counts / sizeof *counts; c++)
+      for (order = 0; order < ORDER_CNT; order++)
+        {
+          size_t size = sizes[s];
+          size_t cnt = counts[c];
+          size_t rounds = 100000 / cnt;
+          uint64_t cycles = 0, ref_cycles = 0;
+          char name[64];
+          size_t r;
+
+          for (r = 0; r < rounds; r++)
+            {
+              uint64_t start;
+
+              fill (array, cnt, size, order);
+              start = rdtsc ();
+              qsort (array, cnt, size, compare_keys);
+              cycles += rdtsc () - start;
+              CHECK (is_sorted (array, cnt, size), "qsort benchmark result");
+
+              fill (array, cnt, size, order);
+              start = rdtsc ();
+              ref_heapsort (array, cnt, size, compare_keys);
+              ref_cycles += rdtsc () - start;
+            }
+          snprintf (name, sizeof name, "qsort %zu x %zu bytes, %s",
+                    cnt, size, order_names[order]);
+          bench_report (name, cycles, rounds * cnt);
+          snprintf (name, sizeof name, "  old heapsort");
+          bench_report (name, ref_cycles, rounds * cnt);
+        }
+  free (array);
+}
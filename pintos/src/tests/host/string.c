@@ -0,0 +1,204 @@
+/* Tests and benchmarks for lib/string.c.
+
+   Checks the memory and string functions against simple
+   byte-at-a-time reference versions for many sizes and
+   alignments, and times the hot ones. */
+
+#include "tests/host/host.h"
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BUF_SIZE 8192
+
+static char buf_a[BUF_SIZE + 64];
+static char buf_b[BUF_SIZE + 64];
+static char buf_c[BUF_SIZE + 64];
+
+/* Fills BUF with SIZE random nonzero bytes. */
+static void
+fill (char *buf, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    buf[i] = 1 + random_upto (254);
+}
+
+/* Returns the sign of X. */
+static int
+sign (int x)
+{
+  return x < 0 ? -1 : x > 0;
+}
+
+static int
+ref_memcmp (const char *a, const char *b, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    if (a[i] != b[i])
+      return (unsigned char) a[i] < (unsigned char) b[i] ? -1 : 1;
+  return 0;
+}
+
+/* Checks memcpy(), memmove(), memset(), memcmp() and strlen()
+   for one SIZE and pair of offsets. */
+static void
+check_mem (size_t size, size_t dst_ofs, size_t src_ofs)
+{
+  char *dst = buf_a + dst_ofs;
+  char *src = buf_b + src_ofs;
+  size_t i;
+
+  fill (buf_a, sizeof buf_a);
+  fill (buf_b, sizeof buf_b);
+  memcpy (buf_c, buf_a, sizeof buf_c);
+
+  CHECK (memcpy (dst, src, size) == dst, "memcpy return value");
+  for (i = 0; i < sizeof buf_a; i++)
+    {
+      char expect = (buf_a + i >= dst && buf_a + i < dst + size
+                     ? src[buf_a + i - dst] : buf_c[i]);
+      if (!CHECK (buf_a[i] == expect, "memcpy size %zu, ofs %zu/%zu, "
+                  "byte %zu", size, dst_ofs, src_ofs, i))
+        break;
+    }
+
+  CHECK (memcmp (dst, src, size) == 0, "memcmp equal, size %zu", size);
+  if (size > 0)
+    {
+      size_t at = random_upto (size - 1);
+      dst[at]++;
+      CHECK (sign (memcmp (dst, src, size)) == ref_memcmp (dst, src, size),
+             "memcmp size %zu, difference at %zu", size, at);
+      CHECK (sign (memcmp (src, dst, size)) == ref_memcmp (src, dst, size),
+             "memcmp size %zu, difference at %zu", size, at);
+    }
+
+  memcpy (buf_c, buf_a, sizeof buf_c);
+  CHECK (memset (dst, src_ofs + 0x80, size) == dst, "memset return value");
+  for (i = 0; i < sizeof buf_a; i++)
+    {
+      char expect = (buf_a + i >= dst && buf_a + i < dst + size
+                     ? (char) (src_ofs + 0x80) : buf_c[i]);
+      if (!CHECK (buf_a[i] == expect, "memset size %zu, ofs %zu, byte %zu",
+                  size, dst_ofs, i))
+        break;
+    }
+
+  src[size] = '\0';
+  CHECK (strlen (src) == size, "strlen %zu at ofs %zu", size, src_ofs);
+
+  /* Overlapping move in both directions. */
+  fill (buf_a, sizeof buf_a);
+  memcpy (buf_c, buf_a, sizeof buf_c);
+  memmove (buf_a + dst_ofs, buf_a + src_ofs, size);
+  CHECK (!memcmp (buf_a + dst_ofs, buf_c + src_ofs, size),
+         "memmove size %zu, ofs %zu/%zu", size, dst_ofs, src_ofs);
+}
+
+void
+test_string (void)
+{
+  static const size_t sizes[] = {0, 1, 2, 3, 4, 7, 8, 15, 16, 17, 31, 33,
+                                 63, 64, 65, 100, 255, 256, 1000, 4096};
+  char tok_buf[64];
+  char *save, *tok;
+  size_t i, d, s;
+
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    for (d = 0; d < 8; d++)
+      for (s = 0; s < 8; s++)
+        check_mem (sizes[i], d, s);
+
+  /* String searching. */
+  strlcpy (tok_buf, "hello, world", sizeof tok_buf);
+  CHECK (strchr (tok_buf, 'l') == tok_buf + 2, "strchr");
+  CHECK (strrchr (tok_buf, 'l') == tok_buf + 10, "strrchr");
+  CHECK (strchr (tok_buf, '\0') == tok_buf + 12, "strchr nul");
+  CHECK (strchr (tok_buf, 'z') == NULL, "strchr absent");
+  CHECK (memchr (tok_buf, 'w', 12) == tok_buf + 7, "memchr");
+  CHECK (memchr (tok_buf, 'w', 7) == NULL, "memchr past size");
+  CHECK (strstr (tok_buf, "wor") == tok_buf + 7, "strstr");
+  CHECK (strstr (tok_buf, "") == tok_buf, "strstr empty");
+  CHECK (strstr (tok_buf, "worlds") == NULL, "strstr absent");
+  CHECK (strspn (tok_buf, "hel") == 4, "strspn");
+  CHECK (strcspn (tok_buf, " ,") == 5, "strcspn");
+  CHECK (strpbrk (tok_buf, "wo") == tok_buf + 4, "strpbrk");
+  CHECK (strcmp ("abc", "abd") < 0 && strcmp ("abd", "abc") > 0
+         && strcmp ("abc", "abc") == 0 && strcmp ("ab", "abc") < 0,
+         "strcmp");
+  CHECK (strnlen (tok_buf, 5) == 5 && strnlen (tok_buf, 50) == 12,
+         "strnlen");
+
+  /* Bounded copies. */
+  CHECK (strlcpy (tok_buf, "abcdef", 4) == 6 && !strcmp (tok_buf, "abc"),
+         "strlcpy truncation");
+  CHECK (strlcat (tok_buf, "xyz", 6) == 6 && !strcmp (tok_buf, "abcxy"),
+         "strlcat truncation");
+
+  /* Tokenizing. */
+  strlcpy (tok_buf, "  a bb\tccc  ", sizeof tok_buf);
+  tok = strtok_r (tok_buf, " \t", &save);
+  CHECK (tok != NULL && !strcmp (tok, "a"), "strtok_r first");
+  tok = strtok_r (NULL, " \t", &save);
+  CHECK (tok != NULL && !strcmp (tok, "bb"), "strtok_r second");
+  tok = strtok_r (NULL, " \t", &save);
+  CHECK (tok != NULL && !strcmp (tok, "ccc"), "strtok_r third");
+  CHECK (strtok_r (NULL, " \t", &save) == NULL, "strtok_r end");
+}
+
+/* Keeps results alive so the compiler cannot discard the calls. */
+static volatile size_t sink;
+
+void
+bench_string (void)
+{
+  static const size_t sizes[] = {16, 64, 512, 4096};
+  size_t i;
+
+  fill (buf_a, sizeof buf_a);
+  fill (buf_b, sizeof buf_b);
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    {
+      size_t size = sizes[i];
+      size_t iterations = 1000000 / size + 100;
+      char name[64];
+      uint64_t start;
+      size_t it;
+      int align;
+
+      for (align = 0; align < 4; align += 3)
+        {
+          snprintf (name, sizeof name, "memcpy %zu bytes, ofs %d",
+                    size, align);
+          start = rdtsc ();
+          for (it = 0; it < iterations; it++)
+            memcpy (buf_a, buf_b + align, size);
+          bench_report (name, rdtsc () - start, iterations);
+        }
+
+      snprintf (name, sizeof name, "memset %zu bytes", size);
+      start = rdtsc ();
+      for (it = 0; it < iterations; it++)
+        memset (buf_a, it, size);
+      bench_report (name, rdtsc () - start, iterations);
+
+      memcpy (buf_a, buf_b, size);
+      snprintf (name, sizeof name, "memcmp %zu equal bytes", size);
+      start = rdtsc ();
+      for (it = 0; it < iterations; it++)
+        sink += memcmp (buf_a, buf_b, size);
+      bench_report (name, rdtsc () - start, iterations);
+
+      buf_b[size] = '\0';
+      snprintf (name, sizeof name, "strlen %zu bytes", size);
+      start = rdtsc ();
+      for (it = 0; it < iterations; it++)
+        sink += strlen (buf_b);
+      bench_report (name, rdtsc () - start, iterations);
+      buf_b[size] = 'x';
+    }
+}
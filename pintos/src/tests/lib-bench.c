@@ -0,0 +1,112 @@
+/* Support shared by the benchmark suites that run as user
+   programs.
+
+   Every benchmark case prints one record, a line of the form
+     TAG bench=NAME [PARAMS] ops=N bytes=N ns=N ns_per_op=N
+       ops_per_sec=N kb_per_sec=N cycles=N cycles_per_op=N
+       [COUNTERS]
+   (all on one line), where TAG is the suite's bench_tag, PARAMS
+   are "key=value" pairs that further identify the case, and
+   COUNTERS give the change in each of the suite's bench_counters
+   over the case, also as "key=value" pairs.  Cycles come from
+   the time-stamp counter, which user programs may read directly,
+   so timing a case costs no system calls beyond the ones it
+   measures.  tests/Make.bench collects the records into
+   bench.results. */
+
+#include "tests/lib-bench.h"
+#include <cpu.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include <time.h>
+
+/* Starts timing case NAME in B. */
+void
+bench_start (struct bench *b, const char *name)
+{
+  size_t i;
+
+  b->name = name;
+  for (i = 0; bench_counters[i].name != NULL; i++)
+    {
+      ASSERT (i < BENCH_MAX_COUNTERS);
+      b->start_counts[i] = bench_counters[i].read ();
+    }
+  b->start_ns = bench_ns ();
+  b->start_cycles = rdtsc ();
+}
+
+/* Stops timing B, which did OPS operations that moved BYTES
+   bytes, and prints its record.  PARAMS, if nonnull, is a string
+   of "key=value" pairs that further identify the case. */
+void
+bench_stop (struct bench *b, const char *params, uint64_t ops,
+            uint64_t bytes)
+{
+  uint64_t cycles = rdtsc () - b->start_cycles;
+  uint64_t ns = bench_ns () - b->start_ns;
+  char counts[256];
+  size_t i, len = 0;
+
+  counts[0] = '\0';
+  for (i = 0; bench_counters[i].name != NULL; i++)
+    len += snprintf (counts + len, sizeof counts - len, " %s=%lld",
+                     bench_counters[i].name,
+                     bench_counters[i].read () - b->start_counts[i]);
+  ASSERT (len < sizeof counts);
+
+  if (ops == 0)
+    ops = 1;
+  if (ns == 0)
+    ns = 1;
+  bench_record (b->name, params,
+                "ops=%llu bytes=%llu ns=%llu ns_per_op=%llu "
+                "ops_per_sec=%llu kb_per_sec=%llu cycles=%llu "
+                "cycles_per_op=%llu%s",
+                ops, bytes, ns, ns / ops, ops * 1000000000 / ns,
+                bytes * 1000000000 / 1024 / ns, cycles, cycles / ops,
+                counts);
+}
+
+/* Returns the monotonic clock, in nanoseconds. */
+uint64_t
+bench_ns (void)
+{
+  struct timespec ts;
+
+  if (clock_gettime (CLOCK_MONOTONIC, &ts) != 0)
+    bench_fail ("clock_gettime failed");
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Prints the record for case NAME, with PARAMS, if nonnull, and
+   the fields given by FORMAT. */
+void
+bench_record (const char *name, const char *params,
+              const char *format, ...)
+{
+  va_list args;
+
+  printf ("%s bench=%s%s%s ", bench_tag, name,
+          params != NULL ? " " : "", params != NULL ? params : "");
+  va_start (args, format);
+  vprintf (format, args);
+  va_end (args);
+  printf ("\n");
+}
+
+/* Prints an error message and exits with failure. */
+void
+bench_fail (const char *format, ...)
+{
+  va_list args;
+
+  printf ("%s: FAIL: ", bench_tag);
+  va_start (args, format);
+  vprintf (format, args);
+  va_end (args);
+  printf ("\n");
+  exit (EXIT_FAILURE);
+}
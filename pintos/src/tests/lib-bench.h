@@ -0,0 +1,45 @@
+#ifndef TESTS_LIB_BENCH_H
+#define TESTS_LIB_BENCH_H
+
+#include <debug.h>
+#include <stdint.h>
+
+/* Most counters that a suite may report. */
+#define BENCH_MAX_COUNTERS 8
+
+/* A counter that a benchmark suite reports, as its change over
+   each case, in addition to the clocks. */
+struct bench_counter
+  {
+    const char *name;           /* Field name, e.g. "dev_reads". */
+    long long (*read) (void);   /* Returns the current value. */
+  };
+
+/* Word that starts every record a benchmark prints, such as
+   "fsbench", so that "make bench" can pick the records out of the
+   console output, and the suite's counters, ending in one with a
+   null name.  Each benchmark suite defines both. */
+extern const char *bench_tag;
+extern const struct bench_counter bench_counters[];
+
+/* One timed benchmark case.  Records the clocks and the suite's
+   counters when started, and reports the differences when
+   stopped. */
+struct bench
+  {
+    const char *name;           /* Case name, e.g. "seq-read". */
+    uint64_t start_ns;          /* Monotonic clock at start. */
+    uint64_t start_cycles;      /* Time-stamp counter at start. */
+    long long start_counts[BENCH_MAX_COUNTERS]; /* Counters at start. */
+  };
+
+void bench_start (struct bench *, const char *name);
+void bench_stop (struct bench *, const char *params,
+                 uint64_t ops, uint64_t bytes);
+
+uint64_t bench_ns (void);
+void bench_record (const char *name, const char *params,
+                   const char *format, ...) PRINTF_FORMAT (3, 4);
+void bench_fail (const char *format, ...) PRINTF_FORMAT (1, 2) NO_RETURN;
+
+#endif /* tests/lib-bench.h */
@@ -0,0 +1,68 @@
+/* Checks that input_read() hands out console input a line at a
+   time: a read stops after a new-line or a carriage return,
+   a short read takes the front of a line and leaves the rest,
+   and a blocking read waits for the end of a partial line. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "devices/input.h"
+#include "devices/timer.h"
+
+static void type (const char *);
+static void expect (size_t size, bool block, const char *want);
+static thread_func finish_line;
+
+void
+test_input_lines (void)
+{
+  type ("one\ntwo\rthree");
+  expect (16, true, "one\n");
+  expect (16, true, "two\r");
+  expect (16, false, "three");
+  expect (16, false, "");
+
+  type ("abcdef\n");
+  expect (3, true, "abc");
+  expect (16, true, "def\n");
+
+  type ("wait");
+  thread_create ("typist", PRI_DEFAULT, finish_line, NULL);
+  expect (16, true, "wait ended\n");
+  pass ();
+}
+
+/* Adds the keys in S to the input buffer, as if typed. */
+static void
+type (const char *s)
+{
+  enum intr_level old_level = intr_disable ();
+  for (; *s != '\0'; s++)
+    input_putc (*s);
+  intr_set_level (old_level);
+}
+
+/* Reads up to SIZE keys and checks that they are WANT. */
+static void
+expect (size_t size, bool block, const char *want)
+{
+  uint8_t buf[16];
+  size_t cnt;
+
+  ASSERT (size <= sizeof buf);
+  cnt = input_read (buf, size, block);
+  if (cnt != strlen (want) || memcmp (buf, want, cnt))
+    fail ("read %zu bytes where \"%s\" was expected", cnt, want);
+  msg ("read %zu bytes", cnt);
+}
+
+/* Completes the pending line after the main thread has had
+   time to block on it. */
+static void
+finish_line (void *aux UNUSED)
+{
+  timer_sleep (10);
+  type (" ended\n");
+}
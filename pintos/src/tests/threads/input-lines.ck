@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(input-lines) begin
+(input-lines) read 4 bytes
+(input-lines) read 4 bytes
+(input-lines) read 5 bytes
+(input-lines) read 0 bytes
+(input-lines) read 3 bytes
+(input-lines) read 4 bytes
+(input-lines) read 11 bytes
+(input-lines) PASS
+(input-lines) end
+EOF
+pass;
@@ -0,0 +1,280 @@
+/* Scheduler and synchronization microbenchmarks.  These are not
+   tests: they always pass, and "make check" does not run them.
+   Each one times a primitive many times with the time-stamp
+   counter and prints one line of the form
+     schedbench bench=NAME ops=N ns=N ops_per_sec=N min_ns=N
+       mean_ns=N p50_ns=N p99_ns=N max_ns=N
+   (all on one line), where ns is the wall-clock time for all the
+   operations and the other *_ns fields describe the distribution
+   of the time for one.
+   "make bench" collects these lines into bench.results.
+
+   Every benchmark runs its threads at the same priority and
+   hands off the CPU explicitly, so the results do not depend on
+   whether the scheduler preempts on wake-up. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "tests/threads/tests.h"
+#include "threads/cpu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Iterations run, untimed, before each benchmark. */
+#define WARMUP_CNT 16
+
+/* Timed iterations per benchmark.  The sleep benchmark runs
+   fewer, since each iteration takes a timer tick. */
+#define SAMPLE_CNT 2000
+#define SLEEP_CNT 200
+
+/* Per-operation times, in nanoseconds. */
+static int64_t samples[SAMPLE_CNT];
+
+/* Compares the int64_t values at A and B for qsort(). */
+static int
+compare_samples (const void *a_, const void *b_)
+{
+  const int64_t *a = a_;
+  const int64_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Prints the record for benchmark NAME, which ran CNT
+   operations in NS nanoseconds, from the CNT entries in
+   samples[], which are sorted in the process. */
+static void
+report (const char *name, int cnt, int64_t ns)
+{
+  int64_t total = 0;
+  int i;
+
+  for (i = 0; i < cnt; i++)
+    total += samples[i];
+  qsort (samples, cnt, sizeof *samples, compare_samples);
+
+  printf ("schedbench bench=%s ops=%d ns=%lld ops_per_sec=%lld "
+          "min_ns=%lld mean_ns=%lld p50_ns=%lld p99_ns=%lld "
+          "max_ns=%lld\n",
+          name, cnt, ns, ns > 0 ? cnt * 1000000000LL / ns : 0,
+          samples[0], total / cnt, samples[cnt / 2],
+          samples[cnt * 99 / 100], samples[cnt - 1]);
+}
+
+/* Returns the nanoseconds elapsed since START, a value returned
+   by rdtsc(). */
+static int64_t
+ns_since (uint64_t start)
+{
+  return timer_cycles_to_ns (rdtsc () - start);
+}
+
+/* Context switch.  Two threads yield to each other, so that each
+   thread_yield() switches away and back again.  One operation is
+   one switch, half of such a round trip. */
+
+static thread_func ctx_switch_thread;
+static volatile bool ctx_switch_done;
+static struct semaphore partner_exited;
+
+void
+test_bench_ctx_switch (void)
+{
+  uint64_t start_ns;
+  int i;
+
+  ctx_switch_done = false;
+  sema_init (&partner_exited, 0);
+  thread_create ("yielder", thread_get_priority (),
+                 ctx_switch_thread, NULL);
+
+  for (i = 0; i < WARMUP_CNT; i++)
+    thread_yield ();
+  start_ns = timer_ns ();
+  for (i = 0; i < SAMPLE_CNT; i++)
+    {
+      uint64_t start = rdtsc ();
+      thread_yield ();
+      samples[i] = ns_since (start) / 2;
+    }
+  ctx_switch_done = true;
+  sema_down (&partner_exited);
+
+  report ("ctx-switch", SAMPLE_CNT, timer_ns () - start_ns);
+}
+
+static void
+ctx_switch_thread (void *aux UNUSED)
+{
+  while (!ctx_switch_done)
+    thread_yield ();
+  sema_up (&partner_exited);
+}
+
+/* Thread creation.  Each operation creates a thread that exits
+   at once and waits for it to run, so that it includes creating,
+   scheduling, exiting, and freeing the thread. */
+
+static thread_func create_thread;
+
+void
+test_bench_create (void)
+{
+  struct semaphore exited;
+  uint64_t start_ns = 0;
+  int i;
+
+  sema_init (&exited, 0);
+  for (i = -WARMUP_CNT; i < SAMPLE_CNT; i++)
+    {
+      uint64_t start;
+
+      if (i == 0)
+        start_ns = timer_ns ();
+      start = rdtsc ();
+      thread_create ("short-lived", thread_get_priority (),
+                     create_thread, &exited);
+      sema_down (&exited);
+      if (i >= 0)
+        samples[i] = ns_since (start);
+    }
+
+  report ("thread-create", SAMPLE_CNT, timer_ns () - start_ns);
+}
+
+static void
+create_thread (void *exited_)
+{
+  struct semaphore *exited = exited_;
+  sema_up (exited);
+}
+
+/* Semaphore ping-pong.  The main thread ups the partner's
+   semaphore and downs its own, which the partner ups in reply.
+   One operation is one round trip. */
+
+static thread_func sema_thread;
+static struct semaphore ping, pong;
+
+void
+test_bench_sema (void)
+{
+  uint64_t start_ns = 0;
+  int i;
+
+  sema_init (&ping, 0);
+  sema_init (&pong, 0);
+  thread_create ("ponger", thread_get_priority (), sema_thread, NULL);
+
+  for (i = -WARMUP_CNT; i < SAMPLE_CNT; i++)
+    {
+      uint64_t start;
+
+      if (i == 0)
+        start_ns = timer_ns ();
+      start = rdtsc ();
+      sema_up (&ping);
+      sema_down (&pong);
+      if (i >= 0)
+        samples[i] = ns_since (start);
+    }
+
+  report ("sema-pingpong", SAMPLE_CNT, timer_ns () - start_ns);
+}
+
+static void
+sema_thread (void *aux UNUSED)
+{
+  int i;
+
+  for (i = -WARMUP_CNT; i < SAMPLE_CNT; i++)
+    {
+      sema_down (&ping);
+      sema_up (&pong);
+    }
+}
+
+/* Lock handoff.  The main thread holds a lock that the partner
+   is blocked acquiring, then releases it and blocks.  One
+   operation is the time from the release until the partner's
+   lock_acquire() returns. */
+
+static thread_func lock_thread;
+static struct lock handoff_lock;
+static struct semaphore lock_start, lock_done;
+static uint64_t release_tsc;
+
+void
+test_bench_lock (void)
+{
+  uint64_t start_ns = 0;
+  int i;
+
+  lock_init (&handoff_lock);
+  sema_init (&lock_start, 0);
+  sema_init (&lock_done, 0);
+  thread_create ("acquirer", thread_get_priority (), lock_thread, NULL);
+
+  for (i = -WARMUP_CNT; i < SAMPLE_CNT; i++)
+    {
+      if (i == 0)
+        start_ns = timer_ns ();
+      lock_acquire (&handoff_lock);
+      sema_up (&lock_start);
+
+      /* Let the partner run until it blocks on the lock. */
+      while (list_empty (&handoff_lock.semaphore.waiters))
+        thread_yield ();
+
+      release_tsc = rdtsc ();
+      lock_release (&handoff_lock);
+      sema_down (&lock_done);
+      if (i >= 0)
+        samples[i] = timer_cycles_to_ns (release_tsc);
+    }
+
+  report ("lock-handoff", SAMPLE_CNT, timer_ns () - start_ns);
+}
+
+static void
+lock_thread (void *aux UNUSED)
+{
+  int i;
+
+  for (i = -WARMUP_CNT; i < SAMPLE_CNT; i++)
+    {
+      sema_down (&lock_start);
+      lock_acquire (&handoff_lock);
+      release_tsc = rdtsc () - release_tsc;
+      lock_release (&handoff_lock);
+      sema_up (&lock_done);
+    }
+}
+
+/* Timer sleep wake-up jitter.  Each operation sleeps one tick,
+   starting just after a tick, and measures how much longer than
+   a tick it took to return.  Lateness can be slightly negative,
+   since the starting point is itself a little after the tick. */
+
+void
+test_bench_sleep (void)
+{
+  const int64_t tick_ns = 1000000000 / TIMER_FREQ;
+  uint64_t start_ns;
+  int i;
+
+  /* Line up with a tick. */
+  timer_sleep (1);
+  start_ns = timer_ns ();
+
+  for (i = 0; i < SLEEP_CNT; i++)
+    {
+      uint64_t start = timer_ns ();
+      timer_sleep (1);
+      samples[i] = (int64_t) (timer_ns () - start) - tick_ns;
+    }
+
+  report ("sleep-jitter", SLEEP_CNT, timer_ns () - start_ns);
+}
@@ -38,6 +38,12 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"input-lines", test_input_lines},
+    {"bench-ctx-switch", test_bench_ctx_switch},
+    {"bench-create", test_bench_create},
+    {"bench-sema", test_bench_sema},
+    {"bench-lock", test_bench_lock},
+    {"bench-sleep", test_bench_sleep},
   };
 
 static const char *test_name;
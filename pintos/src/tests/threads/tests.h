@@ -32,6 +32,12 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_input_lines;
+extern test_func test_bench_ctx_switch;
+extern test_func test_bench_create;
+extern test_func test_bench_sema;
+extern test_func test_bench_lock;
+extern test_func test_bench_sleep;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,11 @@
+/* Child process for psb-spawn.  Exits at once with its argument
+   count as exit code, so that the parent can check that all of
+   its arguments arrived. */
+
+#include <debug.h>
+
+int
+main (int argc, char *argv[] UNUSED)
+{
+  return argc;
+}
@@ -0,0 +1,58 @@
+/* Process spawn cost: exec() followed by wait() of a child that
+   exits at once, with 1, 8, and 32 arguments (the most that
+   load() accepts), so that the cost of passing arguments shows as
+   the difference between the cases. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib-bench.h"
+
+#define SPAWN_CNT 50
+
+const char *bench_tag = "procbench";
+
+/* No counters beyond the clocks. */
+const struct bench_counter bench_counters[] = {{NULL, NULL}};
+
+/* Spawns psb-child with ARGC arguments, counting its name, SPAWN_CNT
+   times. */
+static void
+spawn (int argc)
+{
+  char cmd_line[512];
+  char params[16];
+  struct bench b;
+  int i;
+
+  strlcpy (cmd_line, "psb-child", sizeof cmd_line);
+  for (i = 1; i < argc; i++)
+    strlcat (cmd_line, " argument", sizeof cmd_line);
+  snprintf (params, sizeof params, "argc=%d", argc);
+
+  bench_start (&b, "exec-wait");
+  for (i = 0; i < SPAWN_CNT; i++)
+    {
+      pid_t pid = exec (cmd_line);
+      int status;
+
+      if (pid < 0)
+        bench_fail ("exec \"%s\"", cmd_line);
+      status = wait (pid);
+      if (status != argc)
+        bench_fail ("child exited with %d, expected %d", status, argc);
+    }
+  bench_stop (&b, params, SPAWN_CNT, 0);
+}
+
+int
+main (void)
+{
+  /* Load psb-child once, untimed. */
+  wait (exec ("psb-child"));
+
+  spawn (1);
+  spawn (8);
+  spawn (32);
+  return 0;
+}
@@ -0,0 +1,88 @@
+/* System call costs: a null system call (practice), opening and
+   closing a file, and reading and writing a file a few bytes at a
+   time. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib-bench.h"
+
+#define NULL_CNT 10000
+#define OPEN_CNT 200
+#define RW_CNT 1000
+#define FILE_SIZE 16384
+
+const char *bench_tag = "procbench";
+
+/* No counters beyond the clocks. */
+const struct bench_counter bench_counters[] = {{NULL, NULL}};
+
+static char buf[512];
+
+/* Reads or writes, as WRITING says, RW_CNT blocks of BS bytes
+   through FD, timing it as case NAME.  Goes through the file
+   sequentially, seeking back to its start only to wrap around. */
+static void
+read_write (int fd, bool writing, int bs)
+{
+  char params[16];
+  struct bench b;
+  int i, ofs;
+
+  snprintf (params, sizeof params, "size=%d", bs);
+  seek (fd, 0);
+  ofs = 0;
+  bench_start (&b, writing ? "write" : "read");
+  for (i = 0; i < RW_CNT; i++)
+    {
+      int n;
+
+      if (ofs + bs > FILE_SIZE)
+        {
+          seek (fd, 0);
+          ofs = 0;
+        }
+      n = writing ? write (fd, buf, bs) : read (fd, buf, bs);
+      if (n != bs)
+        bench_fail ("%s %d bytes at offset %d returned %d",
+                    writing ? "write" : "read", bs, ofs, n);
+      ofs += bs;
+    }
+  bench_stop (&b, params, RW_CNT, (uint64_t) RW_CNT * bs);
+}
+
+int
+main (void)
+{
+  static const int sizes[] = {1, 64, 512};
+  const char *file = "rw";
+  struct bench b;
+  size_t i;
+  int fd;
+
+  bench_start (&b, "null-syscall");
+  for (i = 0; i < NULL_CNT; i++)
+    if (practice (i) != (int) i + 1)
+      bench_fail ("practice (%zu)", i);
+  bench_stop (&b, NULL, NULL_CNT, 0);
+
+  if (!create (file, FILE_SIZE))
+    bench_fail ("create \"%s\"", file);
+  bench_start (&b, "open-close");
+  for (i = 0; i < OPEN_CNT; i++)
+    {
+      if ((fd = open (file)) < 0)
+        bench_fail ("open \"%s\"", file);
+      close (fd);
+    }
+  bench_stop (&b, NULL, OPEN_CNT, 0);
+
+  if ((fd = open (file)) < 0)
+    bench_fail ("open \"%s\"", file);
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    {
+      read_write (fd, true, sizes[i]);
+      read_write (fd, false, sizes[i]);
+    }
+  close (fd);
+  return 0;
+}
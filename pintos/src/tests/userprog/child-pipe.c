@@ -0,0 +1,23 @@
+/* Child process run by pipe-exec.
+   Reads standard input until end of file, checking that byte I
+   equals I % 251, and exits with the byte count divided by 100. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-pipe";
+
+int
+main (void)
+{
+  char buf[700];
+  int total = 0;
+  int n, i;
+
+  while ((n = read (STDIN_FILENO, buf, sizeof buf)) > 0)
+    for (i = 0; i < n; i++, total++)
+      if (buf[i] != (char) (total % 251))
+        fail ("byte %d is %d instead of %d", total, buf[i], total % 251);
+  return total / 100;
+}
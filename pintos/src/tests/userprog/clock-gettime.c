@@ -0,0 +1,51 @@
+/* Reads the monotonic and real-time clocks and checks that the
+   monotonic clock never goes backward, ticks in steps much finer
+   than a timer tick, and that unknown clocks are rejected. */
+
+#include <syscall.h>
+#include <time.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Returns TS in nanoseconds. */
+static int64_t
+ts_ns (const struct timespec *ts)
+{
+  return ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+void
+test_main (void)
+{
+  struct timespec a, b, real;
+  int64_t prev, now, step;
+  int i;
+
+  CHECK (clock_gettime (CLOCK_MONOTONIC, &a) == 0, "read monotonic clock");
+  if (a.tv_nsec < 0 || a.tv_nsec >= 1000000000)
+    fail ("tv_nsec out of range: %d", (int) a.tv_nsec);
+
+  /* Never backward. */
+  prev = ts_ns (&a);
+  for (i = 0; i < 10000; i++)
+    {
+      clock_gettime (CLOCK_MONOTONIC, &b);
+      now = ts_ns (&b);
+      if (now < prev)
+        fail ("clock went backward by %lld ns", prev - now);
+      prev = now;
+    }
+
+  /* Advances in steps well under the 10 ms timer tick. */
+  clock_gettime (CLOCK_MONOTONIC, &a);
+  do
+    clock_gettime (CLOCK_MONOTONIC, &b);
+  while (ts_ns (&b) == ts_ns (&a));
+  step = ts_ns (&b) - ts_ns (&a);
+  if (step >= 1000000)
+    fail ("clock advanced in a %lld ns step", step);
+  msg ("clock advances in sub-millisecond steps");
+
+  CHECK (clock_gettime (CLOCK_REALTIME, &real) == 0, "read real-time clock");
+  CHECK (clock_gettime (12345, &a) == -1, "unknown clock rejected");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(clock-gettime) begin
+(clock-gettime) read monotonic clock
+(clock-gettime) clock advances in sub-millisecond steps
+(clock-gettime) read real-time clock
+(clock-gettime) unknown clock rejected
+(clock-gettime) end
+clock-gettime: exit(0)
+EOF
+pass;
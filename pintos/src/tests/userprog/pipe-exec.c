@@ -0,0 +1,35 @@
+/* Runs child-pipe with its standard input connected to a pipe
+   and writes several pages of patterned data into the pipe, so
+   that the writer must block on a full pipe.  The child checks
+   the data and exits with the number of bytes it received
+   divided by 100. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define DATA_SIZE 20000
+
+static char buf[DATA_SIZE];
+
+void
+test_main (void)
+{
+  int fds[2];
+  pid_t pid;
+  size_t i;
+
+  for (i = 0; i < sizeof buf; i++)
+    buf[i] = i % 251;
+
+  if (!pipe (fds))
+    fail ("pipe failed");
+  pid = exec_redirect ("child-pipe", fds[0], -1);
+  if (pid == PID_ERROR)
+    fail ("exec_redirect failed");
+  close (fds[0]);
+  if (write (fds[1], buf, sizeof buf) != sizeof buf)
+    fail ("short write to pipe");
+  close (fds[1]);
+  msg ("child received %d bytes", wait (pid) * 100);
+}
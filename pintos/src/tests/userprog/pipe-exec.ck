@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-exec) begin
+child-pipe: exit(200)
+(pipe-exec) child received 20000 bytes
+(pipe-exec) end
+pipe-exec: exit(0)
+EOF
+pass;
@@ -0,0 +1,33 @@
+/* Reads from a pipe into the read-only code segment, which must
+   fail without modifying it, then checks that the pipe still
+   works. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  static const char sample[] = "sample";
+  char code[sizeof sample];
+  char buf[sizeof sample];
+  int fds[2];
+
+  memcpy (code, (const void *) test_main, sizeof code);
+  CHECK (pipe (fds), "pipe");
+  CHECK (read (fds[0], (void *) test_main, sizeof sample) == -1,
+         "read into code segment fails");
+  CHECK (write (fds[1], sample, sizeof sample) == sizeof sample,
+         "write %zu bytes to pipe", sizeof sample);
+  CHECK (read (fds[0], (void *) test_main, sizeof sample) == -1,
+         "read into code segment fails");
+  if (memcmp (code, (const void *) test_main, sizeof code))
+    fail ("code segment was modified");
+  CHECK (read (fds[0], buf, sizeof buf) == sizeof buf
+         && !memcmp (buf, sample, sizeof sample),
+         "read %zu bytes from pipe", sizeof buf);
+  close (fds[0]);
+  close (fds[1]);
+}
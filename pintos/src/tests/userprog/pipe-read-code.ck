@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-read-code) begin
+(pipe-read-code) pipe
+(pipe-read-code) read into code segment fails
+(pipe-read-code) write 7 bytes to pipe
+(pipe-read-code) read into code segment fails
+(pipe-read-code) read 7 bytes from pipe
+(pipe-read-code) end
+pipe-read-code: exit(0)
+EOF
+pass;
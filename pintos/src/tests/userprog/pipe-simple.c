@@ -0,0 +1,34 @@
+/* Writes to a pipe and reads the data back from the other end
+   within a single process, then checks end-of-file behavior. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  static const char sample[] = "Amazing Electronic Fact: If you scuffed "
+                               "your feet long enough without touching "
+                               "anything, you would build up so many "
+                               "electrons that your finger would explode!";
+  char buf[sizeof sample];
+  int fds[2];
+
+  CHECK (pipe (fds), "pipe");
+  CHECK (fds[0] > 2 && fds[1] > 2 && fds[0] != fds[1],
+         "got two new file descriptors");
+  CHECK (write (fds[1], sample, sizeof sample) == sizeof sample,
+         "write %zu bytes to pipe", sizeof sample);
+  CHECK (read (fds[0], buf, sizeof buf) == sizeof buf,
+         "read %zu bytes from pipe", sizeof buf);
+  if (memcmp (buf, sample, sizeof sample))
+    fail ("data read differs from data written");
+  CHECK (read (fds[1], buf, 1) == -1, "read from write end fails");
+  CHECK (write (fds[0], buf, 1) == -1, "write to read end fails");
+  close (fds[1]);
+  CHECK (read (fds[0], buf, sizeof buf) == 0,
+         "read after closing write end returns 0");
+  close (fds[0]);
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe-simple) begin
+(pipe-simple) pipe
+(pipe-simple) got two new file descriptors
+(pipe-simple) write 158 bytes to pipe
+(pipe-simple) read 158 bytes from pipe
+(pipe-simple) read from write end fails
+(pipe-simple) write to read end fails
+(pipe-simple) read after closing write end returns 0
+(pipe-simple) end
+pipe-simple: exit(0)
+EOF
+pass;
@@ -0,0 +1,22 @@
+/* Puts the console into non-blocking mode and checks that a read
+   with no input pending returns at once instead of waiting.  The
+   test harness runs Pintos with no input, so nothing is ever
+   pending. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  char buf[64];
+
+  CHECK (!nonblock (STDOUT_FILENO, true), "nonblock (1) fails");
+  CHECK (!nonblock (0x20101234, true), "nonblock on a bad fd fails");
+  CHECK (nonblock (STDIN_FILENO, true), "nonblock (0)");
+  CHECK (read (STDIN_FILENO, buf, sizeof buf) == 0,
+         "read with no input pending returns 0");
+  CHECK (nonblock (STDIN_FILENO, false), "restore blocking reads");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(read-nonblock) begin
+(read-nonblock) nonblock (1) fails
+(read-nonblock) nonblock on a bad fd fails
+(read-nonblock) nonblock (0)
+(read-nonblock) read with no input pending returns 0
+(read-nonblock) restore blocking reads
+(read-nonblock) end
+read-nonblock: exit(0)
+EOF
+pass;
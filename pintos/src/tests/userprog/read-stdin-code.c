@@ -0,0 +1,14 @@
+/* Reads from the console into the read-only code segment.
+   The process must be terminated with -1 exit code. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  read (STDIN_FILENO, (void *) test_main, 16);
+  fail ("should not have survived read()");
+}
@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(read-stdin-code) begin
+read-stdin-code: exit(-1)
+EOF
+pass;
@@ -0,0 +1,41 @@
+/* Makes a known number of practice() calls with system call
+   tracing enabled and checks that they show up in both the
+   per-process and the system-wide statistics. */
+
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CALLS 25
+
+void
+test_main (void)
+{
+  struct syscall_stat mine, all;
+  uint64_t hist_sum;
+  int i;
+
+  for (i = 0; i < CALLS; i++)
+    practice (i);
+
+  CHECK (syscall_stat (SYS_PRACTICE, false, &mine),
+         "get per-process practice() statistics");
+  if (mine.count != CALLS)
+    fail ("practice() count is %llu, expected %d", mine.count, CALLS);
+  if (mine.max_cycles > mine.total_cycles)
+    fail ("maximum latency exceeds total latency");
+  hist_sum = 0;
+  for (i = 0; i < SYSCALL_HIST_BUCKETS; i++)
+    hist_sum += mine.hist[i];
+  if (hist_sum != mine.count)
+    fail ("histogram holds %llu calls, expected %llu", hist_sum, mine.count);
+
+  CHECK (syscall_stat (SYS_PRACTICE, true, &all),
+         "get system-wide practice() statistics");
+  if (all.count < mine.count)
+    fail ("system-wide count below per-process count");
+
+  CHECK (!syscall_stat (SYSCALL_STAT_MAX, false, &mine),
+         "untraced system call number rejected");
+}
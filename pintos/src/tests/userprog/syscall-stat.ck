@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(syscall-stat) begin
+(syscall-stat) get per-process practice() statistics
+(syscall-stat) get system-wide practice() statistics
+(syscall-stat) untraced system call number rejected
+(syscall-stat) end
+syscall-stat: exit(0)
+EOF
+pass;
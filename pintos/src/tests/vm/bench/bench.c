@@ -0,0 +1,141 @@
+/* Support for the paging benchmarks.
+
+   Besides the fields that every benchmark record has, each case
+   reports the page faults and swap I/O, in sectors, that it
+   caused, as
+     page_faults=N swap_reads=N swap_writes=N
+   See tests/lib-bench.c. */
+
+#include "tests/vm/bench/bench.h"
+#include <random.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+static long long
+read_page_faults (void)
+{
+  struct vm_stat s;
+
+  vm_stat (&s);
+  return s.page_faults;
+}
+
+static long long
+read_swap_reads (void)
+{
+  struct vm_stat s;
+
+  vm_stat (&s);
+  return s.swap_reads;
+}
+
+static long long
+read_swap_writes (void)
+{
+  struct vm_stat s;
+
+  vm_stat (&s);
+  return s.swap_writes;
+}
+
+const char *bench_tag = "vmbench";
+
+const struct bench_counter bench_counters[] =
+  {
+    {"page_faults", read_page_faults},
+    {"swap_reads", read_swap_reads},
+    {"swap_writes", read_swap_writes},
+    {NULL, NULL},
+  };
+
+/* Parses S as a page count between 1 and MAX_PAGES. */
+size_t
+bench_parse_pages (const char *s)
+{
+  int pages = atoi (s);
+
+  if (pages < 1 || pages > MAX_PAGES)
+    bench_fail ("page count \"%s\" not between 1 and %d", s, MAX_PAGES);
+  return pages;
+}
+
+/* For PATTERN_ZIPF: zipf_cum[K] is the sum of the weights of the
+   pages of rank 0 through K, and zipf_page[K] is the page of rank
+   K.  Ranks are shuffled over the pages, so that the popular
+   pages do not all sit together. */
+#define ZIPF_SCALE (1u << 20)
+static uint32_t zipf_cum[MAX_PAGES];
+static uint16_t zipf_page[MAX_PAGES];
+
+/* Initializes P to produce the pattern named NAME ("seq",
+   "random", or "zipf") over PAGE_CNT pages. */
+void
+pattern_init (struct pattern *p, const char *name, size_t page_cnt)
+{
+  size_t i;
+
+  ASSERT (page_cnt > 0 && page_cnt <= MAX_PAGES);
+  p->page_cnt = page_cnt;
+  p->next = 0;
+  random_init (0x5eed);
+  if (!strcmp (name, "seq"))
+    p->type = PATTERN_SEQ;
+  else if (!strcmp (name, "random"))
+    p->type = PATTERN_RANDOM;
+  else if (!strcmp (name, "zipf"))
+    {
+      uint32_t sum = 0;
+
+      p->type = PATTERN_ZIPF;
+      for (i = 0; i < page_cnt; i++)
+        {
+          size_t j = random_ulong () % (i + 1);
+
+          sum += ZIPF_SCALE / (i + 1);
+          zipf_cum[i] = sum;
+          zipf_page[i] = zipf_page[j];
+          zipf_page[j] = i;
+        }
+    }
+  else
+    bench_fail ("unknown access pattern \"%s\"", name);
+}
+
+/* Returns the next page number in P. */
+size_t
+pattern_next (struct pattern *p)
+{
+  size_t page, lo, hi;
+
+  switch (p->type)
+    {
+    case PATTERN_SEQ:
+      page = p->next;
+      p->next = (p->next + 1) % p->page_cnt;
+      return page;
+
+    case PATTERN_RANDOM:
+      return random_ulong () % p->page_cnt;
+
+    case PATTERN_ZIPF:
+      /* Find the first rank whose cumulative weight exceeds a
+         random point below the total weight. */
+      {
+        uint32_t x = random_ulong () % zipf_cum[p->page_cnt - 1];
+
+        lo = 0;
+        hi = p->page_cnt - 1;
+        while (lo < hi)
+          {
+            size_t mid = lo + (hi - lo) / 2;
+            if (zipf_cum[mid] > x)
+              hi = mid;
+            else
+              lo = mid + 1;
+          }
+        return zipf_page[lo];
+      }
+    }
+  NOT_REACHED ();
+}
@@ -0,0 +1,36 @@
+#ifndef TESTS_VM_BENCH_BENCH_H
+#define TESTS_VM_BENCH_BENCH_H
+
+#include <debug.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "tests/lib-bench.h"
+
+/* Page size, as in threads/vaddr.h. */
+#define PAGE_SIZE 4096
+
+/* Most pages that a benchmark may touch. */
+#define MAX_PAGES 4096
+
+size_t bench_parse_pages (const char *);
+
+/* A sequence of page numbers in [0, PAGE_CNT), in one of the
+   orders that pattern_init() accepts. */
+enum pattern_type
+  {
+    PATTERN_SEQ,                /* 0, 1, ..., PAGE_CNT - 1, 0, ... */
+    PATTERN_RANDOM,             /* Uniformly random. */
+    PATTERN_ZIPF                /* Zipfian: page rank K has weight 1/K. */
+  };
+
+struct pattern
+  {
+    enum pattern_type type;
+    size_t page_cnt;
+    size_t next;                /* Next page, for PATTERN_SEQ. */
+  };
+
+void pattern_init (struct pattern *, const char *name, size_t page_cnt);
+size_t pattern_next (struct pattern *);
+
+#endif /* tests/vm/bench/bench.h */
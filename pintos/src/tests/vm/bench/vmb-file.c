@@ -0,0 +1,82 @@
+/* File access through mmap() versus read().  Usage: vmb-file
+   MODE PATTERN PAGES OPS.  Writes a file of PAGES pages, then
+   makes OPS accesses to pages of it chosen by PATTERN ("seq",
+   "random", or "zipf").  In "mmap" mode, the file is mapped and
+   each access reads one byte of the page, faulting it in if it
+   is not resident; in "read" mode, each access reads the whole
+   page with seek() and read(). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/bench/bench.h"
+
+/* Where the file is mapped, as in the mmap-* tests. */
+#define MAP_ADDR ((char *) 0x10000000)
+
+static char page[PAGE_SIZE];
+
+int
+main (int argc, char *argv[])
+{
+  const char *file = "vmb-data";
+  struct pattern p;
+  struct bench b;
+  char params[64];
+  size_t page_cnt, op_cnt, i;
+  bool use_mmap;
+  int fd;
+
+  if (argc != 5)
+    bench_fail ("usage: vmb-file MODE PATTERN PAGES OPS");
+  if (!strcmp (argv[1], "mmap"))
+    use_mmap = true;
+  else if (!strcmp (argv[1], "read"))
+    use_mmap = false;
+  else
+    bench_fail ("unknown mode \"%s\"", argv[1]);
+  page_cnt = bench_parse_pages (argv[3]);
+  op_cnt = atoi (argv[4]);
+  pattern_init (&p, argv[2], page_cnt);
+
+  if (!create (file, 0) || (fd = open (file)) < 0)
+    bench_fail ("create \"%s\"", file);
+  for (i = 0; i < page_cnt; i++)
+    {
+      memset (page, i, sizeof page);
+      if (write (fd, page, sizeof page) != sizeof page)
+        bench_fail ("write page %zu", i);
+    }
+
+  snprintf (params, sizeof params, "mode=%s pattern=%s pages=%zu",
+            argv[1], argv[2], page_cnt);
+  if (use_mmap)
+    {
+      const volatile char *data = MAP_ADDR;
+      mapid_t map;
+
+      bench_start (&b, "file");
+      map = mmap (fd, MAP_ADDR);
+      if (map == MAP_FAILED)
+        bench_fail ("mmap \"%s\"", file);
+      for (i = 0; i < op_cnt; i++)
+        data[pattern_next (&p) * PAGE_SIZE + i % PAGE_SIZE];
+      munmap (map);
+      bench_stop (&b, params, op_cnt, 0);
+    }
+  else
+    {
+      bench_start (&b, "file");
+      for (i = 0; i < op_cnt; i++)
+        {
+          seek (fd, pattern_next (&p) * PAGE_SIZE);
+          if (read (fd, page, sizeof page) != sizeof page)
+            bench_fail ("read");
+        }
+      bench_stop (&b, params, op_cnt, 0);
+    }
+  close (fd);
+
+  return 0;
+}
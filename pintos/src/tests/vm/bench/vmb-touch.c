@@ -0,0 +1,47 @@
+/* Anonymous memory paging.  Usage: vmb-touch PATTERN PAGES OPS.
+   Touches each of PAGES pages of zero-initialized data once, in
+   order, then makes OPS more read-modify-write accesses, one byte
+   each, to pages chosen by PATTERN ("seq", "random", or "zipf").
+   When PAGES exceeds the memory available to user processes,
+   the second pass measures eviction and swap. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "tests/vm/bench/bench.h"
+
+/* 16 MB of BSS, more than the machine has RAM.  This relies on
+   the kernel loading the BSS lazily, a page at a time as it is
+   first touched, and evicting pages to swap: a kernel that
+   allocates every page of the segment at load time cannot start
+   this program at all. */
+static char arena[MAX_PAGES * PAGE_SIZE];
+
+int
+main (int argc, char *argv[])
+{
+  struct pattern p;
+  struct bench b;
+  char params[64];
+  size_t page_cnt, op_cnt, i;
+
+  if (argc != 4)
+    bench_fail ("usage: vmb-touch PATTERN PAGES OPS");
+  page_cnt = bench_parse_pages (argv[2]);
+  op_cnt = atoi (argv[3]);
+  pattern_init (&p, argv[1], page_cnt);
+
+  snprintf (params, sizeof params, "pages=%zu", page_cnt);
+  bench_start (&b, "populate");
+  for (i = 0; i < page_cnt; i++)
+    arena[i * PAGE_SIZE] = i;
+  bench_stop (&b, params, page_cnt, 0);
+
+  snprintf (params, sizeof params, "pattern=%s pages=%zu",
+            argv[1], page_cnt);
+  bench_start (&b, "touch");
+  for (i = 0; i < op_cnt; i++)
+    arena[pattern_next (&p) * PAGE_SIZE + i % PAGE_SIZE]++;
+  bench_stop (&b, params, op_cnt, 0);
+
+  return 0;
+}
@@ -15,18 +15,23 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/profile.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
+#include "userprog/exec-cache.h"
 #include "userprog/gdt.h"
 #include "userprog/syscall.h"
+#include "userprog/syscall-trace.h"
 #include "userprog/tss.h"
 #else
 #include "tests/threads/tests.h"
@@ -34,8 +39,11 @@
 #ifdef FILESYS
 #include "devices/block.h"
 #include "devices/ide.h"
+#include "filesys/dedup.h"
+#include "filesys/defrag.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
+#include "filesys/journal.h"
 #endif
 
 /* Page directory with kernel mappings only. */
@@ -49,6 +57,16 @@ static bool format_filesys;
    overriding the defaults. */
 static const char *filesys_bdev_name;
 static const char *scratch_bdev_name;
+
+/* -defrag: Seconds between background defragmenter passes, or 0
+   to not run it. */
+static int defrag_interval;
+
+/* -dedup: Deduplicate file data blocks? */
+static bool dedup_filesys;
+
+/* -no-checkpoint: Leave the journal for the next boot to replay? */
+static bool skip_checkpoint;
 #ifdef VM
 static const char *swap_bdev_name;
 #endif
@@ -57,6 +75,21 @@ static const char *swap_bdev_name;
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
+/* Boot timeline: time-stamp counter at the end of each phase of
+   initialization, printed just before "Boot complete". */
+#define BOOT_PHASE_MAX 16
+struct boot_phase
+  {
+    const char *name;           /* Phase that just ended. */
+    uint64_t tsc;               /* Time-stamp counter at its end. */
+  };
+static struct boot_phase boot_phases[BOOT_PHASE_MAX];
+static size_t boot_phase_cnt;
+
+static void boot_phase (const char *name, uint64_t tsc);
+static void print_boot_timeline (void);
+static uint64_t parse_u64 (const char *);
+
 static void bss_init (void);
 static void paging_init (void);
 
@@ -76,10 +109,14 @@ int main (void) NO_RETURN;
 int
 main (void)
 {
+  /* Time-stamp counter on entry, counting cycles since reset.
+     Most of them were spent in the BIOS and the loader. */
+  uint64_t entry_tsc = rdtsc ();
   char **argv;
 
   /* Clear BSS. */
   bss_init ();
+  boot_phase ("BIOS and loader", entry_tsc);
 
   /* Break command line into arguments and parse options. */
   argv = read_command_line ();
@@ -89,6 +126,7 @@ main (void)
      then enable console locking. */
   thread_init ();
   console_init ();
+  boot_phase ("early init", rdtsc ());
 
   /* Greet user. */
   printf ("Pintos booting with %'"PRIu32" kB RAM...\n",
@@ -98,6 +136,7 @@ main (void)
   palloc_init (user_page_limit);
   malloc_init ();
   paging_init ();
+  boot_phase ("memory", rdtsc ());
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -108,25 +147,40 @@ main (void)
   /* Initialize interrupt handlers. */
   intr_init ();
   timer_init ();
+  profile_init ();
+  trace_init ();
   kbd_init ();
   input_init ();
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
+  exec_cache_init ();
 #endif
+  boot_phase ("interrupts", rdtsc ());
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
   serial_init_queue ();
+  boot_phase ("thread start", rdtsc ());
   timer_calibrate ();
+  boot_phase ("timer calibration", rdtsc ());
 
 #ifdef FILESYS
   /* Initialize file system. */
   ide_init ();
+  boot_phase ("disk probing", rdtsc ());
   locate_block_devices ();
   filesys_init (format_filesys);
+  if (dedup_filesys)
+    dedup_enable ();
+  if (skip_checkpoint)
+    journal_skip_checkpoint ();
+  if (defrag_interval > 0)
+    defrag_start (defrag_interval);
+  boot_phase ("file system", rdtsc ());
 #endif
 
+  print_boot_timeline ();
   printf ("Boot complete.\n");
 
   /* Run actions specified on kernel command line. */
@@ -137,6 +191,51 @@ main (void)
   thread_exit ();
 }
 
+/* Records that boot phase NAME ended when the time-stamp
+   counter read TSC. */
+static void
+boot_phase (const char *name, uint64_t tsc)
+{
+  if (boot_phase_cnt < BOOT_PHASE_MAX)
+    {
+      boot_phases[boot_phase_cnt].name = name;
+      boot_phases[boot_phase_cnt].tsc = tsc;
+      boot_phase_cnt++;
+    }
+}
+
+/* Prints the boot timeline.  Times are in time-stamp counter
+   cycles since reset and, once the counter has been calibrated,
+   in milliseconds. */
+static void
+print_boot_timeline (void)
+{
+  uint64_t tsc_hz = timer_tsc_hz ();
+  size_t i;
+
+  printf ("Boot timeline:\n");
+  for (i = 0; i < boot_phase_cnt; i++)
+    {
+      const struct boot_phase *p = &boot_phases[i];
+      uint64_t cycles = p->tsc - (i > 0 ? boot_phases[i - 1].tsc : 0);
+      printf ("  %-18s %'16"PRIu64" cycles", p->name, cycles);
+      if (tsc_hz > 0)
+        printf (", %'8"PRIu64" ms", cycles * 1000 / tsc_hz);
+      printf ("\n");
+    }
+}
+
+/* Parses VALUE as a decimal number that may not fit in an int. */
+static uint64_t
+parse_u64 (const char *value)
+{
+  uint64_t n = 0;
+
+  for (; value != NULL && *value >= '0' && *value <= '9'; value++)
+    n = n * 10 + (*value - '0');
+  return n;
+}
+
 /* Clear the "BSS", a segment that should be initialized to
    zeros.  It isn't actually stored on disk or zeroed by the
    kernel loader, so we have to zero it ourselves.
@@ -247,6 +346,12 @@ parse_options (char **argv)
         filesys_bdev_name = value;
       else if (!strcmp (name, "-scratch"))
         scratch_bdev_name = value;
+      else if (!strcmp (name, "-defrag"))
+        defrag_interval = value != NULL ? atoi (value) : 10;
+      else if (!strcmp (name, "-dedup"))
+        dedup_filesys = true;
+      else if (!strcmp (name, "-no-checkpoint"))
+        skip_checkpoint = true;
 #ifdef VM
       else if (!strcmp (name, "-swap"))
         swap_bdev_name = value;
@@ -256,9 +361,21 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-calibration"))
+        timer_set_calibration (parse_u64 (value));
+      else if (!strcmp (name, "-tsc-hz"))
+        timer_set_tsc_hz (parse_u64 (value));
+      else if (!strcmp (name, "-profile"))
+        profile_configure (value != NULL ? atoi (value) : 0);
+      else if (!strcmp (name, "-trace"))
+        trace_configure (value != NULL ? atoi (value) : 0);
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+      else if (!strcmp (name, "-xcache"))
+        exec_cache_set_page_limit (atoi (value));
+      else if (!strcmp (name, "-sctrace"))
+        syscall_trace_set (value);
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
@@ -373,14 +490,30 @@ usage (void)
           "  -f                 Format file system device during startup.\n"
           "  -filesys=BDEV      Use BDEV for file system instead of default.\n"
           "  -scratch=BDEV      Use BDEV for scratch instead of default.\n"
+          "  -defrag[=SECS]     Defragment files in the background every SECS\n"
+          "                     seconds (default 10).\n"
+          "  -dedup             Share identical file data blocks.\n"
+          "  -no-checkpoint     Power off without checkpointing the journal,\n"
+          "                     leaving it for the next boot to replay.\n"
 #ifdef VM
           "  -swap=BDEV         Use BDEV for swap instead of default.\n"
 #endif
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -calibration=LOOPS Skip timer calibration, using the LOOPS loops/s\n"
+          "                     that an earlier boot printed.\n"
+          "  -tsc-hz=HZ         Skip time-stamp counter calibration, using the\n"
+          "                     HZ that an earlier boot printed.\n"
+          "  -profile[=PAGES]   Sample the running code on every timer tick,\n"
+          "                     using PAGES pages of memory for samples.\n"
+          "  -trace[=PAGES]     Record tracepoints in a PAGES-page ring buffer\n"
+          "                     and dump it at shutdown.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+          "  -xcache=PAGES      Cache up to PAGES pages of program text.\n"
+          "  -sctrace[=exit]    Trace system call latencies; with =exit,\n"
+          "                     print each process's calls as it exits.\n"
 #endif
           );
   shutdown_power_off ();
@@ -0,0 +1,187 @@
+#include "threads/profile.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Sampling profiler.
+
+   When enabled with -profile, every timer interrupt records the
+   interrupted instruction pointer together with the thread that
+   was running.  Samples are aggregated into a histogram keyed on
+   (thread, EIP), an open-addressing hash table that lives in
+   pages allocated at boot, so sampling never allocates memory.
+   Samples that find no free slot are counted as lost.
+
+   At shutdown the histogram is printed to the console, one
+   "Profile:" line per slot in use, for utils/pintos-prof to
+   resolve into a flat profile against kernel.o and the user
+   programs. */
+
+/* Default number of pages for the histogram. */
+#define PROFILE_PAGES 16
+
+/* Maximum number of slots probed before a sample is lost. */
+#define MAX_PROBES 16
+
+/* Maximum number of distinct threads whose names are kept. */
+#define MAX_THREADS 128
+
+/* One histogram slot. */
+struct sample
+  {
+    uintptr_t eip;              /* Sampled instruction pointer. */
+    tid_t tid;                  /* Thread that was running. */
+    uint32_t count;             /* Number of samples; 0 if free. */
+  };
+
+/* Name of a thread that has been sampled. */
+struct sampled_thread
+  {
+    tid_t tid;
+    char name[16];
+  };
+
+static size_t profile_pages;    /* Pages requested, 0 if disabled. */
+static struct sample *samples;  /* Histogram. */
+static size_t sample_slots;     /* Number of slots in SAMPLES. */
+
+static struct sampled_thread threads[MAX_THREADS];
+static size_t thread_cnt;
+
+static uint32_t kernel_samples; /* Samples taken in kernel code. */
+static uint32_t user_samples;   /* Samples taken in user code. */
+static uint32_t lost_samples;   /* Samples dropped, histogram full. */
+
+/* Enables the profiler with a histogram of PAGES pages, or the
+   default size if PAGES is 0.  Must be called before
+   profile_init(). */
+void
+profile_configure (size_t pages)
+{
+  profile_pages = pages > 0 ? pages : PROFILE_PAGES;
+}
+
+/* Allocates the histogram if the profiler is enabled.
+   Must be called after the page allocator is initialized and
+   before the timer starts interrupting. */
+void
+profile_init (void)
+{
+  if (profile_pages == 0)
+    return;
+
+  samples = palloc_get_multiple (PAL_ZERO, profile_pages);
+  if (samples == NULL)
+    PANIC ("profile: cannot allocate %zu pages", profile_pages);
+  sample_slots = profile_pages * PGSIZE / sizeof *samples;
+}
+
+/* Remembers the name of thread T, if it is not already known. */
+static void
+remember_thread (const struct thread *t)
+{
+  size_t i;
+
+  for (i = thread_cnt; i-- > 0; )
+    if (threads[i].tid == t->tid)
+      return;
+  if (thread_cnt < MAX_THREADS)
+    {
+      threads[thread_cnt].tid = t->tid;
+      strlcpy (threads[thread_cnt].name, t->name,
+               sizeof threads[thread_cnt].name);
+      thread_cnt++;
+    }
+}
+
+/* Records a sample of the code interrupted by the timer
+   interrupt whose frame is F.  Called in external interrupt
+   context. */
+void
+profile_sample (const struct intr_frame *f)
+{
+  struct thread *t;
+  uintptr_t eip;
+  size_t slot, i;
+
+  if (samples == NULL)
+    return;
+
+  ASSERT (intr_context ());
+  t = thread_current ();
+  eip = (uintptr_t) f->eip;
+  if (is_user_vaddr (f->eip))
+    user_samples++;
+  else
+    kernel_samples++;
+
+  slot = ((eip * 2654435761u) ^ (unsigned) t->tid) % sample_slots;
+  for (i = 0; i < MAX_PROBES; i++)
+    {
+      struct sample *s = &samples[slot];
+      if (s->count == 0)
+        {
+          s->eip = eip;
+          s->tid = t->tid;
+          s->count = 1;
+          remember_thread (t);
+          return;
+        }
+      if (s->eip == eip && s->tid == t->tid)
+        {
+          s->count++;
+          return;
+        }
+      slot = (slot + 1) % sample_slots;
+    }
+  lost_samples++;
+}
+
+/* Returns the name of the thread with TID, as it was when first
+   sampled. */
+static const char *
+sampled_name (tid_t tid)
+{
+  size_t i;
+
+  for (i = 0; i < thread_cnt; i++)
+    if (threads[i].tid == tid)
+      return threads[i].name;
+  return "?";
+}
+
+/* Prints the profile. */
+void
+profile_print_stats (void)
+{
+  enum intr_level old_level;
+  struct sample *histogram;
+  size_t i;
+
+  /* Stop sampling before walking the histogram. */
+  old_level = intr_disable ();
+  histogram = samples;
+  samples = NULL;
+  intr_set_level (old_level);
+  if (histogram == NULL)
+    return;
+
+  printf ("Profile: %"PRIu32" kernel samples, %"PRIu32" user samples, "
+          "%"PRIu32" lost\n", kernel_samples, user_samples, lost_samples);
+  for (i = 0; i < sample_slots; i++)
+    {
+      const struct sample *s = &histogram[i];
+      if (s->count > 0)
+        printf ("Profile: %d %s %c %#010"PRIxPTR" %"PRIu32"\n",
+                s->tid, sampled_name (s->tid),
+                is_user_vaddr ((void *) s->eip) ? 'u' : 'k',
+                s->eip, s->count);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef THREADS_PROFILE_H
+#define THREADS_PROFILE_H
+
+#include <stddef.h>
+
+struct intr_frame;
+
+void profile_configure (size_t pages);
+void profile_init (void);
+void profile_sample (const struct intr_frame *);
+void profile_print_stats (void);
+
+#endif /* threads/profile.h */
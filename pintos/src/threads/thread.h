@@ -102,6 +102,7 @@ struct ts
    char *file_name;
    struct process_status *ps;
    struct dir *work_dir;
+   struct pipe_end *std_ends[2];   /* Pipe ends for fd 0 and 1, or null for the console. */
 };
 
 struct thread
@@ -125,6 +126,12 @@ struct thread
 
     /* executable that is running by the thread*/
     struct file *file_exec;
+
+    /* Per-system-call statistics, or null if not tracing. */
+    struct syscall_stat *syscall_stats;
+
+    /* Do console reads return without waiting for input? */
+    bool console_nonblock;
 #endif
    // list of all the child threads
   struct list children;
@@ -135,6 +142,10 @@ struct thread
   // list of all file descriptors for this thread
   struct file * file_descriptors[MAX_OPEN_FILE];
 
+  // pipe ends open in this thread, indexed by file descriptor;
+  // entries 0 and 1 redirect stdin and stdout when non-null
+  struct pipe_end * pipe_ends[MAX_OPEN_FILE];
+
   /* Owned by thread.c. */
   unsigned magic;                     /* Detects stack overflow. */
 };
@@ -0,0 +1,173 @@
+#include "threads/trace.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Static tracepoints.
+
+   TRACE() calls placed in the scheduler, system call, page fault,
+   block and buffer cache paths append fixed-size binary records,
+   timestamped with the time-stamp counter, to a ring buffer
+   allocated at boot.  When the ring is full the oldest records
+   are overwritten.
+
+   trace_dump(), called at shutdown, writes the ring to the
+   console as "Trace:" lines: a header giving the record layout,
+   the event names and the time-stamp counter frequency, then the
+   records themselves, hex-encoded so that they survive the trip
+   through the serial port and terminal unchanged.
+   utils/pintos-trace decodes them into a timeline. */
+
+/* Default number of pages for the ring buffer. */
+#define TRACE_PAGES 64
+
+/* Version of the record layout, checked by the decoder. */
+#define TRACE_VERSION 1
+
+/* Bytes of records per "Trace: data" line. */
+#define TRACE_LINE_BYTES 48
+
+/* One event, as stored in the ring and dumped. */
+struct trace_record
+  {
+    uint64_t tsc;               /* Time-stamp counter. */
+    uint16_t event;             /* enum trace_event. */
+    uint16_t tid;               /* Running thread. */
+    uint32_t arg[3];            /* Event-specific arguments. */
+  };
+
+bool trace_enabled;
+
+/* Event names, in dump headers. */
+static const char *const trace_names[TRACE_EVENT_CNT] =
+  {
+    [TRACE_SCHEDULE] = "schedule",
+    [TRACE_SYSCALL_BEGIN] = "syscall-begin",
+    [TRACE_SYSCALL_END] = "syscall-end",
+    [TRACE_PAGE_FAULT] = "page-fault",
+    [TRACE_BLOCK_READ_BEGIN] = "block-read-begin",
+    [TRACE_BLOCK_READ_END] = "block-read-end",
+    [TRACE_BLOCK_WRITE_BEGIN] = "block-write-begin",
+    [TRACE_BLOCK_WRITE_END] = "block-write-end",
+    [TRACE_CACHE_HIT] = "cache-hit",
+    [TRACE_CACHE_MISS] = "cache-miss",
+  };
+
+static size_t trace_pages;      /* Pages requested, 0 if disabled. */
+static struct trace_record *ring;
+static size_t ring_slots;       /* Number of records in RING. */
+static uint64_t event_cnt;      /* Records ever written. */
+
+/* Enables tracing into a ring buffer of PAGES pages, or the
+   default size if PAGES is 0.  Must be called before
+   trace_init(). */
+void
+trace_configure (size_t pages)
+{
+  trace_pages = pages > 0 ? pages : TRACE_PAGES;
+}
+
+/* Allocates the ring buffer and starts tracing, if enabled.
+   Must be called after the page allocator is initialized. */
+void
+trace_init (void)
+{
+  if (trace_pages == 0)
+    return;
+
+  ring = palloc_get_multiple (0, trace_pages);
+  if (ring == NULL)
+    PANIC ("trace: cannot allocate %zu pages", trace_pages);
+  ring_slots = trace_pages * PGSIZE / sizeof *ring;
+  trace_enabled = true;
+}
+
+/* Appends EVENT with arguments ARG0...ARG2 to the ring.  Use
+   TRACE() instead of calling this directly.  May be called from
+   any context. */
+void
+trace_event (enum trace_event event, uint32_t arg0, uint32_t arg1,
+             uint32_t arg2)
+{
+  enum intr_level old_level;
+  struct trace_record *r;
+
+  old_level = intr_disable ();
+  if (ring != NULL)
+    {
+      r = &ring[event_cnt++ % ring_slots];
+      r->tsc = rdtsc ();
+      r->event = event;
+      r->tid = thread_current ()->tid;
+      r->arg[0] = arg0;
+      r->arg[1] = arg1;
+      r->arg[2] = arg2;
+    }
+  intr_set_level (old_level);
+}
+
+/* Prints LEN bytes starting at P as one "Trace: data" line. */
+static void
+dump_line (const uint8_t *p, size_t len)
+{
+  static const char digits[] = "0123456789abcdef";
+  char line[TRACE_LINE_BYTES * 2 + 1];
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      line[i * 2] = digits[p[i] >> 4];
+      line[i * 2 + 1] = digits[p[i] & 0xf];
+    }
+  line[len * 2] = '\0';
+  printf ("Trace: data %s\n", line);
+}
+
+/* Stops tracing and writes the ring buffer, oldest record first,
+   to the console. */
+void
+trace_dump (void)
+{
+  enum intr_level old_level;
+  uint64_t cnt, first, i, tsc_hz;
+  const uint8_t *p;
+  size_t len;
+  int e;
+
+  old_level = intr_disable ();
+  trace_enabled = false;
+  intr_set_level (old_level);
+  if (ring == NULL)
+    return;
+
+  tsc_hz = timer_tsc_hz ();
+  cnt = event_cnt < ring_slots ? event_cnt : ring_slots;
+  first = event_cnt - cnt;
+
+  printf ("Trace: begin %d %zu %"PRIu64" %"PRIu64" %"PRIu64"\n",
+          TRACE_VERSION, sizeof *ring, cnt, first, tsc_hz);
+  for (e = 0; e < TRACE_EVENT_CNT; e++)
+    printf ("Trace: event %d %s\n", e, trace_names[e]);
+
+  /* Dump the records in at most two runs: from the oldest to the
+     end of the ring, then from the start of the ring. */
+  for (i = first; i < event_cnt; i += len / sizeof *ring)
+    {
+      size_t slot = i % ring_slots;
+      size_t run = ring_slots - slot;
+      if (run > event_cnt - i)
+        run = event_cnt - i;
+      if (run > TRACE_LINE_BYTES / sizeof *ring)
+        run = TRACE_LINE_BYTES / sizeof *ring;
+      p = (const uint8_t *) &ring[slot];
+      len = run * sizeof *ring;
+      dump_line (p, len);
+    }
+  printf ("Trace: end\n");
+}
@@ -0,0 +1,50 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tracepoints.  Keep trace_names[] in trace.c in sync; the
+   decoder learns the names from the dump itself. */
+enum trace_event
+  {
+    TRACE_SCHEDULE,             /* Previous tid, next tid. */
+    TRACE_SYSCALL_BEGIN,        /* System call number. */
+    TRACE_SYSCALL_END,          /* System call number, return value. */
+    TRACE_PAGE_FAULT,           /* Fault address, EIP, error code. */
+    TRACE_BLOCK_READ_BEGIN,     /* Sector, block type. */
+    TRACE_BLOCK_READ_END,       /* Sector, block type. */
+    TRACE_BLOCK_WRITE_BEGIN,    /* Sector, block type, compressed size. */
+    TRACE_BLOCK_WRITE_END,      /* Sector, block type. */
+    TRACE_CACHE_HIT,            /* Sector. */
+    TRACE_CACHE_MISS,           /* Sector, evicted sector, was dirty. */
+    TRACE_EVENT_CNT
+  };
+
+/* Record events?
+   Controlled by kernel command-line option "-trace". */
+extern bool trace_enabled;
+
+/* Records EVENT with up to three arguments.  Compiles to nothing
+   if NO_TRACEPOINTS is defined and to a single test of
+   trace_enabled while tracing is off. */
+#ifdef NO_TRACEPOINTS
+#define TRACE(EVENT, ARG0, ARG1, ARG2) ((void) 0)
+#else
+#define TRACE(EVENT, ARG0, ARG1, ARG2)                                  \
+        do                                                              \
+          {                                                             \
+            if (trace_enabled)                                          \
+              trace_event (EVENT, (uint32_t) (ARG0), (uint32_t) (ARG1), \
+                           (uint32_t) (ARG2));                          \
+          }                                                             \
+        while (0)
+#endif
+
+void trace_configure (size_t pages);
+void trace_init (void);
+void trace_event (enum trace_event, uint32_t, uint32_t, uint32_t);
+void trace_dump (void);
+
+#endif /* threads/trace.h */
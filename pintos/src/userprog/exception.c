@@ -4,6 +4,7 @@
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -67,6 +68,13 @@ exception_print_stats (void)
   printf ("Exception: %lld page faults\n", page_fault_cnt);
 }
 
+/* Returns the number of page faults processed. */
+long long
+exception_page_faults (void)
+{
+  return page_fault_cnt;
+}
+
 /* Handler for an exception (probably) caused by a user process. */
 static void
 kill (struct intr_frame *f)
@@ -142,6 +150,7 @@ page_fault (struct intr_frame *f)
 
   /* Count page faults. */
   page_fault_cnt++;
+  TRACE (TRACE_PAGE_FAULT, fault_addr, f->eip, f->error_code);
 
   /* Determine cause. */
   not_present = (f->error_code & PF_P) == 0;
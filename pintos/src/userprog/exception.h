@@ -8,5 +8,6 @@
 
 void exception_init (void);
 void exception_print_stats (void);
+long long exception_page_faults (void);
 
 #endif /* userprog/exception.h */
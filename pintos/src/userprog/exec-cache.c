@@ -0,0 +1,258 @@
+#include "userprog/exec-cache.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Cache of parsed executables, so that exec'ing the same program
+   again skips re-reading and re-validating its ELF headers and,
+   for read-only segments, re-reading its pages from the file
+   system.
+
+   Each cached image holds its inode open, which keeps the
+   in-memory inode, and with it the inode's write generation,
+   alive.  An image whose inode has been written to or removed
+   since it was parsed is stale and gets dropped on the next
+   lookup. */
+
+/* Maximum number of executables kept in the cache. */
+#define EXEC_CACHE_SIZE 8
+
+/* Default limit on pages of prepared read-only contents. */
+#define EXEC_CACHE_PAGES 32
+
+static struct list lru_list;    /* Cached images, least recent first. */
+static size_t image_cnt;        /* Number of images in LRU_LIST. */
+static struct lock exec_cache_lock;
+
+static size_t page_limit = EXEC_CACHE_PAGES;
+static size_t page_cnt;         /* Prepared pages currently held. */
+
+static long long hit_cnt;       /* Lookups that found an image. */
+static long long miss_cnt;      /* Lookups that did not. */
+
+/* Initializes the executable cache. */
+void
+exec_cache_init (void)
+{
+  list_init (&lru_list);
+  lock_init (&exec_cache_lock);
+}
+
+/* Limits the prepared read-only page contents kept by the cache
+   to PAGES pages.  0 disables page caching, leaving only the
+   header cache. */
+void
+exec_cache_set_page_limit (size_t pages)
+{
+  page_limit = pages;
+}
+
+/* Prints executable cache statistics. */
+void
+exec_cache_print_stats (void)
+{
+  printf ("Exec cache: %lld hits, %lld misses, %zu pages cached\n",
+          hit_cnt, miss_cnt, page_cnt);
+}
+
+/* Returns the number of pages spanned by SEG. */
+static size_t
+segment_pages (const struct exec_segment *seg)
+{
+  return (seg->read_bytes + seg->zero_bytes) / PGSIZE;
+}
+
+/* Frees IMAGE and everything it owns.
+   The cache lock must be held. */
+static void
+image_free (struct exec_image *image)
+{
+  size_t i, j;
+
+  for (i = 0; i < image->seg_cnt; i++)
+    {
+      struct exec_segment *seg = &image->segs[i];
+      if (seg->pages == NULL)
+        continue;
+      for (j = 0; j < segment_pages (seg); j++)
+        if (seg->pages[j] != NULL)
+          {
+            palloc_free_page (seg->pages[j]);
+            page_cnt--;
+          }
+      free (seg->pages);
+    }
+  free (image->segs);
+  inode_close (image->inode);
+  free (image);
+}
+
+/* Drops a reference to IMAGE, freeing it if that was the last.
+   The cache lock must be held. */
+static void
+image_unref (struct exec_image *image)
+{
+  ASSERT (image->ref_cnt > 0);
+  if (--image->ref_cnt == 0)
+    image_free (image);
+}
+
+/* Removes IMAGE from the cache.
+   The cache lock must be held. */
+static void
+image_evict (struct exec_image *image)
+{
+  ASSERT (image->cached);
+  list_remove (&image->elem);
+  image->cached = false;
+  image_cnt--;
+  image_unref (image);
+}
+
+/* Returns true if IMAGE no longer matches its executable. */
+static bool
+image_is_stale (const struct exec_image *image)
+{
+  return (inode_get_removed (image->inode)
+          || inode_write_gen (image->inode) != image->write_gen);
+}
+
+/* Creates an empty image for the executable in INODE with room
+   for MAX_SEGS segments.  The caller owns the only reference.
+   Returns a null pointer if memory allocation fails. */
+struct exec_image *
+exec_image_create (struct inode *inode, size_t max_segs)
+{
+  struct exec_image *image = malloc (sizeof *image);
+  if (image == NULL)
+    return NULL;
+
+  image->segs = calloc (max_segs > 0 ? max_segs : 1, sizeof *image->segs);
+  if (image->segs == NULL)
+    {
+      free (image);
+      return NULL;
+    }
+  image->inode = inode_reopen (inode);
+  image->write_gen = inode_write_gen (inode);
+  image->cached = false;
+  image->ref_cnt = 1;
+  image->entry = 0;
+  image->seg_cnt = 0;
+  return image;
+}
+
+/* Looks up the image for the executable in INODE.  Returns it
+   with a new reference, which the caller must drop with
+   exec_cache_release(), or a null pointer if it is not cached
+   or has been modified since it was cached. */
+struct exec_image *
+exec_cache_lookup (struct inode *inode)
+{
+  struct exec_image *found = NULL;
+  struct list_elem *e, *next;
+
+  lock_acquire (&exec_cache_lock);
+  for (e = list_begin (&lru_list); e != list_end (&lru_list); e = next)
+    {
+      struct exec_image *image = list_entry (e, struct exec_image, elem);
+      next = list_next (e);
+
+      if (image_is_stale (image))
+        image_evict (image);
+      else if (image->inode == inode)
+        found = image;
+    }
+
+  if (found != NULL)
+    {
+      list_remove (&found->elem);
+      list_push_back (&lru_list, &found->elem);
+      found->ref_cnt++;
+      hit_cnt++;
+    }
+  else
+    miss_cnt++;
+  lock_release (&exec_cache_lock);
+
+  return found;
+}
+
+/* Adds IMAGE, whose segments have been filled in, to the cache.
+   The caller keeps its own reference.  Evicts the least recently
+   used image if the cache is full. */
+void
+exec_cache_insert (struct exec_image *image)
+{
+  struct list_elem *e;
+  size_t i;
+
+  ASSERT (!image->cached);
+
+  lock_acquire (&exec_cache_lock);
+
+  /* Another process may have loaded the same executable
+     concurrently.  Keep the image that is already there. */
+  for (e = list_begin (&lru_list); e != list_end (&lru_list);
+       e = list_next (e))
+    if (list_entry (e, struct exec_image, elem)->inode == image->inode)
+      {
+        lock_release (&exec_cache_lock);
+        return;
+      }
+
+  if (page_limit > 0)
+    for (i = 0; i < image->seg_cnt; i++)
+      {
+        struct exec_segment *seg = &image->segs[i];
+        if (!seg->writable)
+          seg->pages = calloc (segment_pages (seg), sizeof *seg->pages);
+      }
+
+  list_push_back (&lru_list, &image->elem);
+  image->cached = true;
+  image->ref_cnt++;
+  if (++image_cnt > EXEC_CACHE_SIZE)
+    image_evict (list_entry (list_front (&lru_list), struct exec_image, elem));
+
+  lock_release (&exec_cache_lock);
+}
+
+/* Drops the caller's reference to IMAGE. */
+void
+exec_cache_release (struct exec_image *image)
+{
+  lock_acquire (&exec_cache_lock);
+  image_unref (image);
+  lock_release (&exec_cache_lock);
+}
+
+/* Offers KPAGE, the freshly loaded contents of page PAGE_IDX of
+   SEG in IMAGE, to the cache.  If SEG is read-only and the page
+   budget allows, keeps a copy that later loads can use instead
+   of reading the file. */
+void
+exec_cache_fill_page (struct exec_image *image, struct exec_segment *seg,
+                      size_t page_idx, const void *kpage)
+{
+  if (seg->pages == NULL || !image->cached)
+    return;
+
+  lock_acquire (&exec_cache_lock);
+  if (image->cached && seg->pages[page_idx] == NULL && page_cnt < page_limit)
+    {
+      void *copy = palloc_get_page (0);
+      if (copy != NULL)
+        {
+          memcpy (copy, kpage, PGSIZE);
+          seg->pages[page_idx] = copy;
+          page_cnt++;
+        }
+    }
+  lock_release (&exec_cache_lock);
+}
@@ -0,0 +1,48 @@
+#ifndef USERPROG_EXEC_CACHE_H
+#define USERPROG_EXEC_CACHE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct inode;
+
+/* A loadable segment of an executable, already validated and
+   split into the page-granular form that load_segment() wants. */
+struct exec_segment
+  {
+    uint32_t file_page;         /* Page-aligned offset in the file. */
+    uint32_t mem_page;          /* Page-aligned user virtual address. */
+    uint32_t read_bytes;        /* Bytes to read from the file. */
+    uint32_t zero_bytes;        /* Bytes to zero after READ_BYTES. */
+    bool writable;              /* Mapped writable? */
+    void **pages;               /* Prepared page contents, or null.
+                                   Only kept for read-only segments. */
+  };
+
+/* Parsed ELF metadata of one executable. */
+struct exec_image
+  {
+    struct list_elem elem;      /* Element in the cache's LRU list. */
+    struct inode *inode;        /* Executable, held open while cached. */
+    unsigned write_gen;         /* inode_write_gen() when parsed. */
+    bool cached;                /* In the LRU list? */
+    int ref_cnt;                /* Loaders using this image, plus cache. */
+    uint32_t entry;             /* Entry point. */
+    size_t seg_cnt;             /* Number of segments. */
+    struct exec_segment *segs;  /* Loadable segments. */
+  };
+
+void exec_cache_init (void);
+void exec_cache_set_page_limit (size_t pages);
+void exec_cache_print_stats (void);
+
+struct exec_image *exec_image_create (struct inode *, size_t max_segs);
+struct exec_image *exec_cache_lookup (struct inode *);
+void exec_cache_insert (struct exec_image *);
+void exec_cache_release (struct exec_image *);
+void exec_cache_fill_page (struct exec_image *, struct exec_segment *,
+                           size_t page_idx, const void *kpage);
+
+#endif /* userprog/exec-cache.h */
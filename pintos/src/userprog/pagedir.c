@@ -156,6 +156,32 @@ pagedir_clear_page (uint32_t *pd, void *upage)
     }
 }
 
+/* Returns true if virtual page VPAGE is mapped writable in PD.
+   Returns false if PD contains no PTE for VPAGE. */
+bool
+pagedir_is_writable (uint32_t *pd, const void *vpage)
+{
+  uint32_t *pte = lookup_page (pd, vpage, false);
+  return pte != NULL && (*pte & PTE_P) != 0 && (*pte & PTE_W) != 0;
+}
+
+/* Returns true if every page of the SIZE bytes at user address
+   UADDR is mapped writable in PD.  The kernel writes to user
+   memory with write protection ignored, through its own mapping
+   of the pages or with CR0.WP clear, so it must check this before
+   writing where a user asked it to. */
+bool
+pagedir_range_writable (uint32_t *pd, const void *uaddr, size_t size)
+{
+  const uint8_t *start = uaddr;
+  const uint8_t *page;
+
+  for (page = pg_round_down (start); page < start + size; page += PGSIZE)
+    if (!pagedir_is_writable (pd, page))
+      return false;
+  return true;
+}
+
 /* Returns true if the PTE for virtual page VPAGE in PD is dirty,
    that is, if the page has been modified since the PTE was
    installed.
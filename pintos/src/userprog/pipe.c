@@ -0,0 +1,273 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Capacity of a pipe's ring buffer: one page. */
+#define PIPE_BUFSIZE PGSIZE
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+/* One end of a pipe.  Both ends are embedded in the pipe itself,
+   so a file descriptor only needs a pointer to its end. */
+struct pipe_end
+  {
+    struct pipe *pipe;          /* Pipe this end belongs to. */
+    bool writer;                /* True for the write end. */
+    int ref_cnt;                /* File descriptors referring to this end. */
+  };
+
+/* A unidirectional byte stream between processes. */
+struct pipe
+  {
+    struct lock lock;           /* Protects all members below. */
+    struct condition not_empty; /* Data arrived or last writer left. */
+    struct condition not_full;  /* Room freed up or last reader left. */
+    uint8_t *buf;               /* Ring buffer, PIPE_BUFSIZE bytes. */
+    size_t head;                /* Offset of the first unread byte. */
+    size_t used;                /* Number of unread bytes. */
+    struct pipe_end ends[2];    /* Read end, write end. */
+
+    /* Direct-copy rendezvous.  A reader that finds the ring empty
+       publishes its destination here, and the next writer copies
+       straight into the reader's buffer instead of the ring. */
+    uint32_t *rdv_pagedir;      /* Waiting reader's page directory. */
+    uint8_t *rdv_buf;           /* Waiting reader's user buffer. */
+    size_t rdv_size;            /* Room in RDV_BUF. */
+    size_t rdv_done;            /* Bytes delivered into RDV_BUF. */
+  };
+
+/* Creates a new pipe and stores its two ends, each with a single
+   reference, into *READ_END and *WRITE_END.
+   Returns false if memory allocation fails. */
+bool
+pipe_create (struct pipe_end **read_end, struct pipe_end **write_end)
+{
+  struct pipe *p = malloc (sizeof *p);
+  if (p == NULL)
+    return false;
+
+  p->buf = palloc_get_page (0);
+  if (p->buf == NULL)
+    {
+      free (p);
+      return false;
+    }
+
+  lock_init (&p->lock);
+  cond_init (&p->not_empty);
+  cond_init (&p->not_full);
+  p->head = p->used = 0;
+  p->rdv_pagedir = NULL;
+  p->rdv_buf = NULL;
+  p->rdv_size = p->rdv_done = 0;
+
+  p->ends[0].pipe = p;
+  p->ends[0].writer = false;
+  p->ends[0].ref_cnt = 1;
+  p->ends[1].pipe = p;
+  p->ends[1].writer = true;
+  p->ends[1].ref_cnt = 1;
+
+  *read_end = &p->ends[0];
+  *write_end = &p->ends[1];
+  return true;
+}
+
+/* Adds a reference to END and returns it. */
+struct pipe_end *
+pipe_end_dup (struct pipe_end *end)
+{
+  struct pipe *p = end->pipe;
+
+  lock_acquire (&p->lock);
+  ASSERT (end->ref_cnt > 0);
+  end->ref_cnt++;
+  lock_release (&p->lock);
+  return end;
+}
+
+/* Drops a reference to END.  Closing the last reference to the
+   write end makes readers see end of file; closing the last
+   reference to the read end makes writers fail.  The pipe is
+   freed once neither end is referenced. */
+void
+pipe_end_close (struct pipe_end *end)
+{
+  struct pipe *p;
+  bool dead;
+
+  if (end == NULL)
+    return;
+
+  p = end->pipe;
+  lock_acquire (&p->lock);
+  ASSERT (end->ref_cnt > 0);
+  end->ref_cnt--;
+  cond_broadcast (&p->not_empty, &p->lock);
+  cond_broadcast (&p->not_full, &p->lock);
+  dead = p->ends[0].ref_cnt == 0 && p->ends[1].ref_cnt == 0;
+  lock_release (&p->lock);
+
+  if (dead)
+    {
+      palloc_free_page (p->buf);
+      free (p);
+    }
+}
+
+/* Returns true if END is the write end of its pipe. */
+bool
+pipe_end_is_writer (const struct pipe_end *end)
+{
+  return end->writer;
+}
+
+/* Copies SIZE bytes from kernel buffer SRC to user address DST in
+   the address space described by page directory PD, which need
+   not be the active one.  Every page of DST must be mapped. */
+static void
+copy_to_pagedir (uint32_t *pd, uint8_t *dst, const uint8_t *src, size_t size)
+{
+  while (size > 0)
+    {
+      size_t chunk = MIN (size, PGSIZE - pg_ofs (dst));
+      uint8_t *kdst = pagedir_get_page (pd, dst);
+
+      ASSERT (kdst != NULL);
+      memcpy (kdst, src, chunk);
+      dst += chunk;
+      src += chunk;
+      size -= chunk;
+    }
+}
+
+/* Reads up to SIZE bytes from the pipe behind read end END into
+   BUFFER, a user buffer in the running process whose pages must
+   all be mapped.  Blocks until at least one byte is available or
+   every write end has been closed.  Returns the number of bytes
+   read, which is 0 at end of file, or -1 if some page of BUFFER
+   is read-only.  A writer may copy into BUFFER through the
+   kernel's mapping of its pages, which does not honor user
+   page protection, so this has to be checked up front. */
+int
+pipe_read (struct pipe_end *end, void *buffer_, unsigned size)
+{
+  struct pipe *p = end->pipe;
+  uint8_t *buffer = buffer_;
+  size_t bytes_read = 0;
+
+  ASSERT (!end->writer);
+
+  if (size == 0)
+    return 0;
+  if (!pagedir_range_writable (thread_current ()->pagedir, buffer, size))
+    return -1;
+
+  lock_acquire (&p->lock);
+  while (p->used == 0 && p->ends[1].ref_cnt > 0)
+    {
+      if (p->rdv_pagedir != NULL)
+        {
+          /* Another reader already owns the rendezvous. */
+          cond_wait (&p->not_empty, &p->lock);
+          continue;
+        }
+
+      /* Let the next writer copy straight into BUFFER. */
+      p->rdv_pagedir = thread_current ()->pagedir;
+      p->rdv_buf = buffer;
+      p->rdv_size = size;
+      p->rdv_done = 0;
+      while (p->rdv_done == 0 && p->ends[1].ref_cnt > 0)
+        cond_wait (&p->not_empty, &p->lock);
+      bytes_read = p->rdv_done;
+      p->rdv_pagedir = NULL;
+      p->rdv_done = 0;
+      if (bytes_read > 0)
+        goto done;
+    }
+
+  /* Drain the ring buffer, in at most two pieces. */
+  while (bytes_read < size && p->used > 0)
+    {
+      size_t chunk = MIN (size - bytes_read,
+                          MIN (p->used, PIPE_BUFSIZE - p->head));
+      memcpy (buffer + bytes_read, p->buf + p->head, chunk);
+      p->head = (p->head + chunk) % PIPE_BUFSIZE;
+      p->used -= chunk;
+      bytes_read += chunk;
+    }
+
+ done:
+  cond_broadcast (&p->not_full, &p->lock);
+  lock_release (&p->lock);
+  return bytes_read;
+}
+
+/* Writes SIZE bytes from BUFFER, a user buffer in the running
+   process, into the pipe behind write end END.  Blocks while the
+   pipe is full.  Returns the number of bytes written, which is
+   less than SIZE only if every read end was closed in the
+   meantime, or -1 if no reader was left to begin with. */
+int
+pipe_write (struct pipe_end *end, const void *buffer_, unsigned size)
+{
+  struct pipe *p = end->pipe;
+  const uint8_t *buffer = buffer_;
+  size_t bytes_written = 0;
+
+  ASSERT (end->writer);
+
+  lock_acquire (&p->lock);
+  while (bytes_written < size)
+    {
+      size_t tail, chunk;
+
+      if (p->ends[0].ref_cnt == 0)
+        {
+          if (bytes_written == 0)
+            {
+              lock_release (&p->lock);
+              return -1;
+            }
+          break;
+        }
+
+      /* A reader is blocked on an empty pipe: hand the data over
+         directly.  The ring is necessarily empty here, so byte
+         order is preserved. */
+      if (p->rdv_pagedir != NULL && p->rdv_done == 0)
+        {
+          ASSERT (p->used == 0);
+          chunk = MIN (size - bytes_written, p->rdv_size);
+          copy_to_pagedir (p->rdv_pagedir, p->rdv_buf,
+                           buffer + bytes_written, chunk);
+          p->rdv_done = chunk;
+          bytes_written += chunk;
+          cond_broadcast (&p->not_empty, &p->lock);
+          continue;
+        }
+
+      if (p->used == PIPE_BUFSIZE)
+        {
+          cond_wait (&p->not_full, &p->lock);
+          continue;
+        }
+
+      tail = (p->head + p->used) % PIPE_BUFSIZE;
+      chunk = MIN (size - bytes_written,
+                   MIN (PIPE_BUFSIZE - p->used, PIPE_BUFSIZE - tail));
+      memcpy (p->buf + tail, buffer + bytes_written, chunk);
+      p->used += chunk;
+      bytes_written += chunk;
+      cond_broadcast (&p->not_empty, &p->lock);
+    }
+  lock_release (&p->lock);
+  return bytes_written;
+}
@@ -0,0 +1,17 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct pipe_end;
+
+bool pipe_create (struct pipe_end **read_end, struct pipe_end **write_end);
+struct pipe_end *pipe_end_dup (struct pipe_end *);
+void pipe_end_close (struct pipe_end *);
+bool pipe_end_is_writer (const struct pipe_end *);
+
+int pipe_read (struct pipe_end *, void *buffer, unsigned size);
+int pipe_write (struct pipe_end *, const void *buffer, unsigned size);
+
+#endif /* userprog/pipe.h */
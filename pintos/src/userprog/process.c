@@ -5,8 +5,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "userprog/exec-cache.h"
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
+#include "userprog/pipe.h"
+#include "userprog/syscall-trace.h"
 #include "userprog/tss.h"
 #include "filesys/directory.h"
 #include "filesys/file.h"
@@ -38,9 +41,22 @@ create_process_status (void)
 /* Starts a new thread running a user program loaded from
    FILENAME.  The new thread may be scheduled (and may even exit)
    before process_execute() returns.  Returns the new process's
-   thread id, or TID_ERROR if the thread cannot be created. */
+   thread id, or TID_ERROR if the thread cannot be created.
+   The child inherits the caller's stdin and stdout. */
 tid_t
 process_execute (const char *file_name)
+{
+  struct thread *cur = thread_current ();
+  return process_execute_redirect (file_name, cur->pipe_ends[0],
+                                   cur->pipe_ends[1]);
+}
+
+/* Like process_execute(), but the child reads its stdin from pipe
+   end STDIN_END and writes its stdout to pipe end STDOUT_END.
+   A null end means the console. */
+tid_t
+process_execute_redirect (const char *file_name, struct pipe_end *stdin_end,
+                          struct pipe_end *stdout_end)
 {
   char *fn_copy, *fn_threadname_copy;
   tid_t tid;
@@ -74,6 +90,11 @@ process_execute (const char *file_name)
 
   ts_copy->file_name = fn_copy;
 
+  /* The child owns these references from now on; it drops them
+     when it exits. */
+  ts_copy->std_ends[0] = stdin_end != NULL ? pipe_end_dup (stdin_end) : NULL;
+  ts_copy->std_ends[1] = stdout_end != NULL ? pipe_end_dup (stdout_end) : NULL;
+
   /* Create a new thread to execute FILE_NAME. */
   tid = thread_create (fn_threadname_copy, PRI_DEFAULT, start_process, ts_copy);
   palloc_free_page (fn_threadname_copy);
@@ -81,6 +102,8 @@ process_execute (const char *file_name)
   /* Wait for the process to fully load. */
   if (tid == TID_ERROR) 
   {
+    pipe_end_close (ts_copy->std_ends[0]);
+    pipe_end_close (ts_copy->std_ends[1]);
     palloc_free_page (fn_copy);
     free (ps);
     return TID_ERROR;
@@ -108,6 +131,8 @@ start_process (void *ts)
   struct thread *current_thread = thread_current ();
   current_thread->tstatus = ps;
   ps->pid = current_thread->tid;
+  current_thread->pipe_ends[0] = ts_copy->std_ends[0];
+  current_thread->pipe_ends[1] = ts_copy->std_ends[1];
 
   char *file_name = ts_copy->file_name;
   struct intr_frame if_;
@@ -118,7 +143,8 @@ start_process (void *ts)
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
-  success = load (file_name, &if_.eip, &if_.esp);
+  success = (syscall_trace_process_start (current_thread)
+             && load (file_name, &if_.eip, &if_.esp));
   if (ts_copy->work_dir != NULL)
     current_thread->work_dir = dir_reopen (ts_copy->work_dir);
   else 
@@ -232,6 +258,16 @@ process_exit (void)
   struct thread *current_thread = thread_current ();
   struct process_status *status = current_thread->tstatus;
   uint32_t *pd;
+  int fd;
+
+  syscall_trace_process_exit (current_thread);
+
+  /* Close pipe ends first so that peers see end of file. */
+  for (fd = 0; fd < MAX_OPEN_FILE; fd++)
+    {
+      pipe_end_close (current_thread->pipe_ends[fd]);
+      current_thread->pipe_ends[fd] = NULL;
+    }
 
   lock_acquire (&status->lock);
   status->ref_count --;
@@ -343,9 +379,9 @@ struct Elf32_Phdr
 
 static bool setup_stack (void **esp, char *argv[], int argc);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
-static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
-                          uint32_t read_bytes, uint32_t zero_bytes,
-                          bool writable);
+static struct exec_image *parse_executable (struct file *, const char *name);
+static bool load_segment (struct file *file, struct exec_image *image,
+                          struct exec_segment *seg);
 
 /* Limits for filename. */
 #define MAX_ARGS 32
@@ -384,11 +420,10 @@ bool
 load (const char *file_name, void (**eip) (void), void **esp)
 {
   struct thread *t = thread_current ();
-  struct Elf32_Ehdr ehdr;
+  struct exec_image *image = NULL;
   struct file *file = NULL;
-  off_t file_ofs;
   bool success = false;
-  int i;
+  size_t i;
 
   char *file_name_copy = palloc_get_page (0); 
   char **argv = palloc_get_page (0);
@@ -414,89 +449,35 @@ load (const char *file_name, void (**eip) (void), void **esp)
   /* deny write to executable */
   file_deny_write (file);
 
-  /* Read and verify executable header. */
-  if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
-      || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
-      || ehdr.e_type != 2
-      || ehdr.e_machine != 3
-      || ehdr.e_version != 1
-      || ehdr.e_phentsize != sizeof (struct Elf32_Phdr)
-      || ehdr.e_phnum > 1024)
-    {
-      printf ("load: %s: error loading executable\n", argv[0]);
-      goto done;
-    }
-
-  /* Read program headers. */
-  file_ofs = ehdr.e_phoff;
-  for (i = 0; i < ehdr.e_phnum; i++)
+  /* Reuse the parsed headers of an earlier load of the same
+     executable, unless it has been written since. */
+  image = exec_cache_lookup (file_get_inode (file));
+  if (image == NULL)
     {
-      struct Elf32_Phdr phdr;
-
-      if (file_ofs < 0 || file_ofs > file_length (file))
+      image = parse_executable (file, argv[0]);
+      if (image == NULL)
         goto done;
-      file_seek (file, file_ofs);
-
-      if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
-        goto done;
-      file_ofs += sizeof phdr;
-      switch (phdr.p_type)
-        {
-        case PT_NULL:
-        case PT_NOTE:
-        case PT_PHDR:
-        case PT_STACK:
-        default:
-          /* Ignore this segment. */
-          break;
-        case PT_DYNAMIC:
-        case PT_INTERP:
-        case PT_SHLIB:
-          goto done;
-        case PT_LOAD:
-          if (validate_segment (&phdr, file))
-            {
-              bool writable = (phdr.p_flags & PF_W) != 0;
-              uint32_t file_page = phdr.p_offset & ~PGMASK;
-              uint32_t mem_page = phdr.p_vaddr & ~PGMASK;
-              uint32_t page_offset = phdr.p_vaddr & PGMASK;
-              uint32_t read_bytes, zero_bytes;
-              if (phdr.p_filesz > 0)
-                {
-                  /* Normal segment.
-                     Read initial part from disk and zero the rest. */
-                  read_bytes = page_offset + phdr.p_filesz;
-                  zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
-                                - read_bytes);
-                }
-              else
-                {
-                  /* Entirely zero.
-                     Don't read anything from disk. */
-                  read_bytes = 0;
-                  zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
-                }
-              if (!load_segment (file, file_page, (void *) mem_page,
-                                 read_bytes, zero_bytes, writable))
-                goto done;
-            }
-          else
-            goto done;
-          break;
-        }
+      exec_cache_insert (image);
     }
+
+  /* Load segments. */
+  for (i = 0; i < image->seg_cnt; i++)
+    if (!load_segment (file, image, &image->segs[i]))
+      goto done;
   
   /* Set up stack. */
   if (!setup_stack (esp, argv, argc))
     goto done;
 
   /* Start address. */
-  *eip = (void (*) (void)) ehdr.e_entry;
+  *eip = (void (*) (void)) image->entry;
 
   success = true;
 
  done:
   /* We arrive here whether the load is successful or not. */
+  if (image != NULL)
+    exec_cache_release (image);
   palloc_free_page (file_name_copy);
   palloc_free_page (argv);
   t->file_exec = file;
@@ -552,30 +533,130 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
   return true;
 }
 
-/* Loads a segment starting at offset OFS in FILE at address
-   UPAGE.  In total, READ_BYTES + ZERO_BYTES bytes of virtual
-   memory are initialized, as follows:
+/* Reads and validates FILE's ELF header and program headers.
+   Returns a new image describing its loadable segments, owned by
+   the caller, or a null pointer if FILE is not a valid
+   executable or memory is short.  NAME is used in messages. */
+static struct exec_image *
+parse_executable (struct file *file, const char *name)
+{
+  struct Elf32_Ehdr ehdr;
+  struct exec_image *image;
+  off_t file_ofs;
+  int i;
+
+  /* Read and verify executable header. */
+  file_seek (file, 0);
+  if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
+      || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
+      || ehdr.e_type != 2
+      || ehdr.e_machine != 3
+      || ehdr.e_version != 1
+      || ehdr.e_phentsize != sizeof (struct Elf32_Phdr)
+      || ehdr.e_phnum > 1024)
+    {
+      printf ("load: %s: error loading executable\n", name);
+      return NULL;
+    }
+
+  image = exec_image_create (file_get_inode (file), ehdr.e_phnum);
+  if (image == NULL)
+    return NULL;
+  image->entry = ehdr.e_entry;
+
+  /* Read program headers. */
+  file_ofs = ehdr.e_phoff;
+  for (i = 0; i < ehdr.e_phnum; i++)
+    {
+      struct Elf32_Phdr phdr;
+      struct exec_segment *seg;
+
+      if (file_ofs < 0 || file_ofs > file_length (file))
+        goto error;
+      file_seek (file, file_ofs);
+
+      if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
+        goto error;
+      file_ofs += sizeof phdr;
+      switch (phdr.p_type)
+        {
+        case PT_NULL:
+        case PT_NOTE:
+        case PT_PHDR:
+        case PT_STACK:
+        default:
+          /* Ignore this segment. */
+          break;
+        case PT_DYNAMIC:
+        case PT_INTERP:
+        case PT_SHLIB:
+          goto error;
+        case PT_LOAD:
+          if (!validate_segment (&phdr, file))
+            goto error;
+
+          seg = &image->segs[image->seg_cnt++];
+          seg->writable = (phdr.p_flags & PF_W) != 0;
+          seg->file_page = phdr.p_offset & ~PGMASK;
+          seg->mem_page = phdr.p_vaddr & ~PGMASK;
+          seg->pages = NULL;
+          uint32_t page_offset = phdr.p_vaddr & PGMASK;
+          if (phdr.p_filesz > 0)
+            {
+              /* Normal segment.
+                 Read initial part from disk and zero the rest. */
+              seg->read_bytes = page_offset + phdr.p_filesz;
+              seg->zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
+                                 - seg->read_bytes);
+            }
+          else
+            {
+              /* Entirely zero.
+                 Don't read anything from disk. */
+              seg->read_bytes = 0;
+              seg->zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
+            }
+          break;
+        }
+    }
+  return image;
+
+ error:
+  exec_cache_release (image);
+  return NULL;
+}
 
-        - READ_BYTES bytes at UPAGE must be read from FILE
-          starting at offset OFS.
+/* Loads segment SEG of IMAGE, whose executable is open as FILE.
+   In total, SEG->READ_BYTES + SEG->ZERO_BYTES bytes of virtual
+   memory starting at SEG->MEM_PAGE are initialized, as follows:
 
-        - ZERO_BYTES bytes at UPAGE + READ_BYTES must be zeroed.
+        - SEG->READ_BYTES bytes at SEG->MEM_PAGE must be read
+          from FILE starting at offset SEG->FILE_PAGE.
+
+        - SEG->ZERO_BYTES bytes after those must be zeroed.
+
+   Pages whose contents the executable cache has prepared are
+   copied from there instead of being read from FILE.
 
    The pages initialized by this function must be writable by the
-   user process if WRITABLE is true, read-only otherwise.
+   user process if SEG->WRITABLE is true, read-only otherwise.
 
    Return true if successful, false if a memory allocation error
    or disk read error occurs. */
 static bool
-load_segment (struct file *file, off_t ofs, uint8_t *upage,
-              uint32_t read_bytes, uint32_t zero_bytes, bool writable)
+load_segment (struct file *file, struct exec_image *image,
+              struct exec_segment *seg)
 {
+  uint8_t *upage = (uint8_t *) seg->mem_page;
+  uint32_t read_bytes = seg->read_bytes;
+  uint32_t zero_bytes = seg->zero_bytes;
+  size_t page_idx;
+
   ASSERT ((read_bytes + zero_bytes) % PGSIZE == 0);
   ASSERT (pg_ofs (upage) == 0);
-  ASSERT (ofs % PGSIZE == 0);
+  ASSERT (seg->file_page % PGSIZE == 0);
 
-  file_seek (file, ofs);
-  while (read_bytes > 0 || zero_bytes > 0)
+  for (page_idx = 0; read_bytes > 0 || zero_bytes > 0; page_idx++)
     {
       /* Calculate how to fill this page.
          We will read PAGE_READ_BYTES bytes from FILE
@@ -589,15 +670,22 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
         return false;
 
       /* Load this page. */
-      if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes)
+      if (seg->pages != NULL && seg->pages[page_idx] != NULL)
+        memcpy (kpage, seg->pages[page_idx], PGSIZE);
+      else
         {
-          palloc_free_page (kpage);
-          return false;
+          file_seek (file, seg->file_page + page_idx * PGSIZE);
+          if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes)
+            {
+              palloc_free_page (kpage);
+              return false;
+            }
+          memset (kpage + page_read_bytes, 0, page_zero_bytes);
+          exec_cache_fill_page (image, seg, page_idx, kpage);
         }
-      memset (kpage + page_read_bytes, 0, page_zero_bytes);
 
       /* Add the page to the process's address space. */
-      if (!install_page (upage, kpage, writable))
+      if (!install_page (upage, kpage, seg->writable))
         {
           palloc_free_page (kpage);
           return false;
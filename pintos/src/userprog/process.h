@@ -3,7 +3,12 @@
 
 #include "threads/thread.h"
 
+struct pipe_end;
+
 tid_t process_execute (const char *file_name);
+tid_t process_execute_redirect (const char *file_name,
+                                struct pipe_end *stdin_end,
+                                struct pipe_end *stdout_end);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
@@ -0,0 +1,240 @@
+#include "userprog/syscall-trace.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include <syscall-nr.h>
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* System call tracing.
+
+   When enabled with -sctrace, syscall_handler() times every
+   system call that returns to user space with the time-stamp
+   counter and records its latency both in a system-wide table
+   and in a table owned by the calling process.  exit() and calls
+   that kill the process never return, so they are not counted.
+
+   When disabled, the only cost is the test of
+   syscall_trace_enabled on entry and exit. */
+
+bool syscall_trace_enabled;
+
+/* Print each process's table when it exits?
+   Set by "-sctrace=exit". */
+static bool trace_at_exit;
+
+/* System-wide statistics. */
+static struct syscall_stat global_stats[SYSCALL_STAT_MAX];
+
+/* Cycles spent reading the time-stamp counter twice, subtracted
+   from every sample. */
+static uint64_t tsc_overhead;
+
+/* Names of traced system calls, for printing. */
+static const char *const syscall_names[SYSCALL_STAT_MAX] =
+  {
+    [SYS_HALT] = "halt",
+    [SYS_EXIT] = "exit",
+    [SYS_EXEC] = "exec",
+    [SYS_WAIT] = "wait",
+    [SYS_CREATE] = "create",
+    [SYS_REMOVE] = "remove",
+    [SYS_OPEN] = "open",
+    [SYS_FILESIZE] = "filesize",
+    [SYS_READ] = "read",
+    [SYS_WRITE] = "write",
+    [SYS_SEEK] = "seek",
+    [SYS_TELL] = "tell",
+    [SYS_CLOSE] = "close",
+    [SYS_PRACTICE] = "practice",
+    [SYS_MMAP] = "mmap",
+    [SYS_MUNMAP] = "munmap",
+    [SYS_CHDIR] = "chdir",
+    [SYS_MKDIR] = "mkdir",
+    [SYS_READDIR] = "readdir",
+    [SYS_ISDIR] = "isdir",
+    [SYS_INUMBER] = "inumber",
+    [SYS_CACHE_STAT] = "cache_stat",
+    [SYS_INVALIDATE_CACHE] = "invalidate_cache",
+    [SYS_PIPE] = "pipe",
+    [SYS_EXEC_REDIRECT] = "exec_redirect",
+    [SYS_SYSCALL_STAT] = "syscall_stat",
+    [SYS_NONBLOCK] = "nonblock",
+    [SYS_CLOCK_GETTIME] = "clock_gettime",
+    [SYS_VM_STAT] = "vm_stat",
+    [SYS_FSYNC] = "fsync",
+    [SYS_FDATASYNC] = "fdatasync",
+    [SYS_DEFRAG] = "defrag",
+    [SYS_DIRECT_IO] = "direct_io",
+  };
+
+/* Measures the cost of the tracing itself. */
+void
+syscall_trace_init (void)
+{
+  int i;
+
+  tsc_overhead = UINT64_MAX;
+  for (i = 0; i < 64; i++)
+    {
+      uint64_t start = rdtsc ();
+      uint64_t cycles = rdtsc () - start;
+      if (cycles < tsc_overhead)
+        tsc_overhead = cycles;
+    }
+}
+
+/* Enables tracing.  MODE is the value of the -sctrace option: a
+   null pointer just collects statistics, "exit" also prints each
+   process's statistics when it exits. */
+void
+syscall_trace_set (const char *mode)
+{
+  if (mode != NULL && strcmp (mode, "exit"))
+    PANIC ("unknown -sctrace mode `%s'", mode);
+  syscall_trace_enabled = true;
+  trace_at_exit = mode != NULL;
+}
+
+/* Adds a call that took CYCLES to S. */
+static void
+stat_add (struct syscall_stat *s, uint64_t cycles)
+{
+  uint64_t scaled = cycles >> SYSCALL_HIST_SHIFT;
+  int bucket;
+
+  if (scaled > UINT32_MAX)
+    bucket = SYSCALL_HIST_BUCKETS - 1;
+  else if (scaled == 0)
+    bucket = 0;
+  else
+    {
+      bucket = 31 - __builtin_clz ((uint32_t) scaled);
+      if (bucket > SYSCALL_HIST_BUCKETS - 1)
+        bucket = SYSCALL_HIST_BUCKETS - 1;
+    }
+
+  s->count++;
+  s->total_cycles += cycles;
+  if (cycles > s->max_cycles)
+    s->max_cycles = cycles;
+  s->hist[bucket]++;
+}
+
+/* Records that system call NR, made by the running thread, took
+   CYCLES cycles. */
+void
+syscall_trace_record (unsigned nr, uint64_t cycles)
+{
+  struct thread *t = thread_current ();
+  enum intr_level old_level;
+
+  if (nr >= SYSCALL_STAT_MAX)
+    return;
+  cycles = cycles > tsc_overhead ? cycles - tsc_overhead : 0;
+
+  if (t->syscall_stats != NULL)
+    stat_add (&t->syscall_stats[nr], cycles);
+
+  old_level = intr_disable ();
+  stat_add (&global_stats[nr], cycles);
+  intr_set_level (old_level);
+}
+
+/* Copies the statistics for system call NR into *S: for the whole
+   system if ALL is true, otherwise for the running process.
+   Returns false if tracing is disabled or NR is not traced. */
+bool
+syscall_trace_get (unsigned nr, bool all, struct syscall_stat *s)
+{
+  struct thread *t = thread_current ();
+  enum intr_level old_level;
+
+  if (!syscall_trace_enabled || nr >= SYSCALL_STAT_MAX)
+    return false;
+
+  if (!all)
+    {
+      if (t->syscall_stats == NULL)
+        return false;
+      *s = t->syscall_stats[nr];
+      return true;
+    }
+
+  old_level = intr_disable ();
+  *s = global_stats[nr];
+  intr_set_level (old_level);
+  return true;
+}
+
+/* Sets up per-process statistics for T, a new user process.
+   Returns false if memory allocation fails. */
+bool
+syscall_trace_process_start (struct thread *t)
+{
+  if (!syscall_trace_enabled)
+    return true;
+  t->syscall_stats = calloc (SYSCALL_STAT_MAX, sizeof *t->syscall_stats);
+  return t->syscall_stats != NULL;
+}
+
+/* Prints one line per system call in STATS that was called. */
+static void
+print_table (const struct syscall_stat stats[SYSCALL_STAT_MAX])
+{
+  unsigned nr;
+
+  for (nr = 0; nr < SYSCALL_STAT_MAX; nr++)
+    {
+      const struct syscall_stat *s = &stats[nr];
+      if (s->count == 0)
+        continue;
+      printf ("  %-16s %8llu calls, %10llu avg, %10llu max cycles\n",
+              syscall_names[nr] != NULL ? syscall_names[nr] : "?",
+              s->count, s->total_cycles / s->count, s->max_cycles);
+    }
+}
+
+/* Prints T's statistics if requested, and frees them. */
+void
+syscall_trace_process_exit (struct thread *t)
+{
+  if (t->syscall_stats == NULL)
+    return;
+  if (trace_at_exit)
+    {
+      printf ("%s: system calls:\n", t->name);
+      print_table (t->syscall_stats);
+    }
+  free (t->syscall_stats);
+  t->syscall_stats = NULL;
+}
+
+/* Prints system-wide system call statistics, with latency
+   histograms. */
+void
+syscall_trace_print_stats (void)
+{
+  unsigned nr;
+  int b;
+
+  if (!syscall_trace_enabled)
+    return;
+
+  printf ("System calls: %llu cycles tracing overhead, "
+          "histogram buckets from 2^%d cycles:\n",
+          tsc_overhead, SYSCALL_HIST_SHIFT + 1);
+  print_table (global_stats);
+  for (nr = 0; nr < SYSCALL_STAT_MAX; nr++)
+    {
+      const struct syscall_stat *s = &global_stats[nr];
+      if (s->count == 0)
+        continue;
+      printf ("  %-16s", syscall_names[nr] != NULL ? syscall_names[nr] : "?");
+      for (b = 0; b < SYSCALL_HIST_BUCKETS; b++)
+        printf (" %u", (unsigned) s->hist[b]);
+      printf ("\n");
+    }
+}
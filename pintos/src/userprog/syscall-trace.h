@@ -0,0 +1,23 @@
+#ifndef USERPROG_SYSCALL_TRACE_H
+#define USERPROG_SYSCALL_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <syscall-stat.h>
+
+struct thread;
+
+/* Collect system call statistics?
+   Controlled by kernel command-line option "-sctrace". */
+extern bool syscall_trace_enabled;
+
+void syscall_trace_init (void);
+void syscall_trace_set (const char *mode);
+void syscall_trace_record (unsigned nr, uint64_t cycles);
+bool syscall_trace_get (unsigned nr, bool all, struct syscall_stat *);
+
+bool syscall_trace_process_start (struct thread *);
+void syscall_trace_process_exit (struct thread *);
+void syscall_trace_print_stats (void);
+
+#endif /* userprog/syscall-trace.h */
@@ -2,8 +2,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <syscall-nr.h>
+#include <time.h>
+#include <vm-stat.h>
+#include "devices/block.h"
+#include "devices/input.h"
+#include "devices/rtc.h"
+#include "devices/timer.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "userprog/exception.h"
 #include "userprog/pagedir.h"
 #include "threads/vaddr.h"
 #include "threads/synch.h"
@@ -11,8 +18,13 @@
 #include "filesys/filesys.h"
 #include "filesys/directory.h"
 #include "filesys/cache.h"
+#include "filesys/defrag.h"
 #include "filesys/inode.h"
 #include "process.h"
+#include "pipe.h"
+#include "syscall-trace.h"
+#include "threads/cpu.h"
+#include "threads/trace.h"
 
 static void syscall_handler(struct intr_frame *);
 static void syscall_practice(struct intr_frame *, uint32_t *);
@@ -35,10 +47,30 @@ static void syscall_isdir(struct intr_frame *, uint32_t *, struct thread *);
 static void syscall_inumber(struct intr_frame *, uint32_t *, struct thread *);
 static void syscall_cache_stat(struct intr_frame *, uint32_t *, struct thread *);
 static void syscall_invalidate_cache(struct intr_frame *, uint32_t *);
+static void syscall_pipe (struct intr_frame *, uint32_t *, struct thread *);
+static void syscall_exec_redirect (struct intr_frame *, uint32_t *, struct thread *);
+static void syscall_syscall_stat (struct intr_frame *, uint32_t *);
+static void syscall_nonblock (struct intr_frame *, uint32_t *, struct thread *);
+static void syscall_clock_gettime (struct intr_frame *, uint32_t *);
+static void syscall_vm_stat (struct intr_frame *, uint32_t *);
+static void syscall_fsync (struct intr_frame *, uint32_t *, struct thread *,
+                           bool data_only);
+static void syscall_defrag (struct intr_frame *);
+static void syscall_direct_io (struct intr_frame *, uint32_t *, struct thread *);
+
+/* Wall-clock time when timer_ns() read 0, in seconds since the
+   Unix epoch.  timer_ns() counts from timer_init(), which runs
+   just before syscall_init(), and the real-time clock only has
+   one-second resolution, so the current RTC time serves.  (The
+   TSC is not calibrated yet, so timer_ns() cannot be used to
+   correct for the difference.) */
+static int64_t boot_time;
 
 void syscall_init (void)
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
+  boot_time = rtc_get_time ();
+  syscall_trace_init ();
 }
 
 static bool
@@ -68,6 +100,45 @@ check_address (const void *vaddr)
   return false;
 }
 
+/* Checks that every page of the SIZE-byte user buffer BUFFER is
+   mapped. */
+static bool
+check_buffer (const void *buffer, unsigned size)
+{
+  const uint8_t *start = buffer;
+  const uint8_t *page;
+
+  if (!check_address (start))
+    return false;
+  for (page = pg_round_down (start) + PGSIZE; page < start + size;
+       page += PGSIZE)
+    if (!check_address (page))
+      return false;
+  return true;
+}
+
+/* Returns the pipe end behind FD in thread T, or null if FD is
+   not a pipe. */
+static struct pipe_end *
+get_pipe_end (struct thread *t, int fd)
+{
+  if (fd < 0 || fd >= MAX_OPEN_FILE)
+    return NULL;
+  return t->pipe_ends[fd];
+}
+
+/* Returns the lowest free file descriptor in thread T that is at
+   least FIRST, or -1 if all are in use. */
+static int
+allocate_fd (struct thread *t, int first)
+{
+  int fd;
+  for (fd = first; fd < MAX_OPEN_FILE; fd++)
+    if (t->file_descriptors[fd] == NULL && t->pipe_ends[fd] == NULL)
+      return fd;
+  return -1;
+}
+
 static bool
 check_string (char * str)
 {
@@ -87,6 +158,9 @@ syscall_handler (struct intr_frame *f UNUSED)
 
 
   struct thread *current_thread = thread_current ();
+  uint32_t nr = args[0];
+  uint64_t start = syscall_trace_enabled ? rdtsc () : 0;
+  TRACE (TRACE_SYSCALL_BEGIN, nr, 0, 0);
 
   switch (args[0])
   {
@@ -152,9 +226,43 @@ syscall_handler (struct intr_frame *f UNUSED)
   case SYS_INVALIDATE_CACHE:
     syscall_invalidate_cache (f, args);
     break;
+  case SYS_PIPE:
+    syscall_pipe (f, args, current_thread);
+    break;
+  case SYS_EXEC_REDIRECT:
+    syscall_exec_redirect (f, args, current_thread);
+    break;
+  case SYS_SYSCALL_STAT:
+    syscall_syscall_stat (f, args);
+    break;
+  case SYS_NONBLOCK:
+    syscall_nonblock (f, args, current_thread);
+    break;
+  case SYS_CLOCK_GETTIME:
+    syscall_clock_gettime (f, args);
+    break;
+  case SYS_VM_STAT:
+    syscall_vm_stat (f, args);
+    break;
+  case SYS_FSYNC:
+    syscall_fsync (f, args, current_thread, false);
+    break;
+  case SYS_FDATASYNC:
+    syscall_fsync (f, args, current_thread, true);
+    break;
+  case SYS_DEFRAG:
+    syscall_defrag (f);
+    break;
+  case SYS_DIRECT_IO:
+    syscall_direct_io (f, args, current_thread);
+    break;
   default:
     break;
   }
+
+  if (syscall_trace_enabled)
+    syscall_trace_record (nr, rdtsc () - start);
+  TRACE (TRACE_SYSCALL_END, nr, f->eax, 0);
 }
 
 
@@ -185,6 +293,16 @@ syscall_write (struct intr_frame *f, uint32_t *args, struct thread *current_thre
     syscall_exit (f, -1);
 
   f->eax = -1;
+  struct pipe_end *pipe_end = get_pipe_end (current_thread, fd);
+  if (pipe_end != NULL)
+  {
+    if (!check_buffer (buffer, size))
+      syscall_exit (f, -1);
+    if (pipe_end_is_writer (pipe_end))
+      f->eax = pipe_write (pipe_end, buffer, size);
+    return;
+  }
+
   if (fd == 1 || fd == 2)
   {
     putbuf(buffer, size);
@@ -241,14 +359,8 @@ syscall_open (struct intr_frame *f, uint32_t *args, struct thread *current_threa
       !check_string (name))
     syscall_exit (f, -1);
 
-  int fd = 3;
-  for (fd; fd < MAX_OPEN_FILE; fd++)
-  {
-    if (current_thread->file_descriptors[fd] == NULL)
-      break;
-  }
-
-  if (fd == MAX_OPEN_FILE)
+  int fd = allocate_fd (current_thread, 3);
+  if (fd == -1)
   {
     f->eax = -1;
     return;
@@ -270,6 +382,15 @@ syscall_close (struct intr_frame *f, uint32_t *args, struct thread *current_thre
 {
   int fd = args[1];
 
+  struct pipe_end *pipe_end = get_pipe_end (current_thread, fd);
+  if (pipe_end != NULL && fd >= 3)
+  {
+    pipe_end_close (pipe_end);
+    current_thread->pipe_ends[fd] = NULL;
+    f->eax = 1;
+    return;
+  }
+
   if (!check_fd (current_thread, fd) ||
       fd < 3)
     syscall_exit (f, -1);
@@ -285,21 +406,19 @@ syscall_close (struct intr_frame *f, uint32_t *args, struct thread *current_thre
   f->eax = 1;
 }
 
+/* Reads at most one line of console input into BUFFER, which
+   has room for SIZE bytes, and returns the number of bytes read.
+   A new-line or carriage return that ends the line is replaced
+   by a null terminator.  Waits for a whole line, or SIZE bytes, unless
+   BLOCK is false. */
 static unsigned
-get_input_buffer (char *buffer, unsigned size)
+get_input_buffer (char *buffer, unsigned size, bool block)
 {
-  size_t i = 0;
+  size_t n = input_read ((uint8_t *) buffer, size, block);
 
-  while (i < size)
-  {
-    buffer[i] = input_getc ();
-    if (buffer[i++] == '\n')
-    {
-      buffer[i-1] = '\0';
-      break;
-    }
-  }
-  return i;
+  if (n > 0 && (buffer[n - 1] == '\n' || buffer[n - 1] == '\r'))
+    buffer[n - 1] = '\0';
+  return n;
 }
 
 static void
@@ -312,9 +431,26 @@ syscall_read (struct intr_frame *f, uint32_t *args, struct thread *current_threa
   if (!check_address (buffer))
     syscall_exit (f, -1);
 
+  struct pipe_end *pipe_end = get_pipe_end (current_thread, fd);
+  if (pipe_end != NULL)
+  {
+    if (!check_buffer (buffer, size))
+      syscall_exit (f, -1);
+    f->eax = -1;
+    if (!pipe_end_is_writer (pipe_end))
+      f->eax = pipe_read (pipe_end, buffer, size);
+    return;
+  }
+
   if (fd == 0)
   {
-    f->eax = get_input_buffer (buffer, size);
+    /* input_read() copies into BUFFER holding its lock, so it
+       must not fault. */
+    if (!check_buffer (buffer, size)
+        || !pagedir_range_writable (current_thread->pagedir, buffer, size))
+      syscall_exit (f, -1);
+    f->eax = get_input_buffer (buffer, size,
+                               !current_thread->console_nonblock);
     return;
   }
 
@@ -323,6 +459,11 @@ syscall_read (struct intr_frame *f, uint32_t *args, struct thread *current_threa
       fd == 2)
     syscall_exit (f, -1);
 
+  /* file_read() fills BUFFER holding cache or device locks, with
+     direct I/O straight from the disk, so it must not fault. */
+  if (!check_buffer (buffer, size)
+      || !pagedir_range_writable (current_thread->pagedir, buffer, size))
+    syscall_exit (f, -1);
   f->eax = file_read (current_thread->file_descriptors[fd], buffer, size);
 }
 
@@ -495,3 +636,190 @@ syscall_invalidate_cache (struct intr_frame *f, uint32_t *args)
   cache_invalidate (fs_device);
   f->eax = 1;
 }
+
+static void
+syscall_pipe (struct intr_frame *f, uint32_t *args, struct thread *current_thread)
+{
+  int *fds = (int *) args[1];
+  struct pipe_end *read_end, *write_end;
+
+  if (!check_buffer (fds, 2 * sizeof *fds))
+    syscall_exit (f, -1);
+
+  f->eax = false;
+  int read_fd = allocate_fd (current_thread, 3);
+  if (read_fd == -1)
+    return;
+  int write_fd = allocate_fd (current_thread, read_fd + 1);
+  if (write_fd == -1 || !pipe_create (&read_end, &write_end))
+    return;
+
+  current_thread->pipe_ends[read_fd] = read_end;
+  current_thread->pipe_ends[write_fd] = write_end;
+  fds[0] = read_fd;
+  fds[1] = write_fd;
+  f->eax = true;
+}
+
+/* Resolves FD, an argument to exec_redirect(), into the pipe end
+   the child should use for the standard stream that FD replaces.
+   -1 keeps the caller's own stream.  Returns false if FD is not a
+   pipe end of the required direction. */
+static bool
+redirect_end (struct thread *t, int fd, int std_fd, bool writer,
+              struct pipe_end **end)
+{
+  if (fd == -1)
+    {
+      *end = t->pipe_ends[std_fd];
+      return true;
+    }
+  *end = get_pipe_end (t, fd);
+  return *end != NULL && pipe_end_is_writer (*end) == writer;
+}
+
+static void
+syscall_exec_redirect (struct intr_frame *f, uint32_t *args, struct thread *current_thread)
+{
+  char *name = (char *) args[1];
+  int stdin_fd = (int) args[2];
+  int stdout_fd = (int) args[3];
+  struct pipe_end *stdin_end, *stdout_end;
+
+  if (!check_address (name) ||
+      !check_string (name))
+    syscall_exit (f, -1);
+
+  if (!redirect_end (current_thread, stdin_fd, 0, false, &stdin_end) ||
+      !redirect_end (current_thread, stdout_fd, 1, true, &stdout_end))
+  {
+    f->eax = -1;
+    return;
+  }
+
+  f->eax = process_execute_redirect (name, stdin_end, stdout_end);
+}
+
+static void
+syscall_syscall_stat (struct intr_frame *f, uint32_t *args)
+{
+  unsigned nr = args[1];
+  bool all = args[2] != 0;
+  struct syscall_stat *stat = (struct syscall_stat *) args[3];
+
+  if (!check_buffer (stat, sizeof *stat))
+    syscall_exit (f, -1);
+
+  f->eax = syscall_trace_get (nr, all, stat);
+}
+
+/* Sets whether reads from file descriptor args[1] return at once
+   with whatever input is available.  Only the console supports
+   this, so it fails for any descriptor other than 0, or for 0
+   when it is redirected. */
+static void
+syscall_nonblock (struct intr_frame *f, uint32_t *args,
+                  struct thread *current_thread)
+{
+  int fd = (int) args[1];
+  bool nonblock = args[2] != 0;
+
+  f->eax = false;
+  if (fd == 0 && get_pipe_end (current_thread, fd) == NULL)
+    {
+      current_thread->console_nonblock = nonblock;
+      f->eax = true;
+    }
+}
+
+/* Stores the time on clock args[1] in the timespec at args[2].
+   Returns 0 if successful, -1 for an unknown clock. */
+static void
+syscall_clock_gettime (struct intr_frame *f, uint32_t *args)
+{
+  clockid_t clock = (clockid_t) args[1];
+  struct timespec *ts = (struct timespec *) args[2];
+  uint64_t ns;
+
+  if (!check_buffer (ts, sizeof *ts))
+    syscall_exit (f, -1);
+
+  ns = timer_ns ();
+  f->eax = 0;
+  switch (clock)
+    {
+    case CLOCK_MONOTONIC:
+      ts->tv_sec = ns / 1000000000;
+      break;
+    case CLOCK_REALTIME:
+      ts->tv_sec = boot_time + ns / 1000000000;
+      break;
+    default:
+      f->eax = -1;
+      return;
+    }
+  ts->tv_nsec = ns % 1000000000;
+}
+
+/* Stores paging statistics in the vm_stat at args[1].  Swap
+   counts are 0 when there is no swap device. */
+static void
+syscall_vm_stat (struct intr_frame *f, uint32_t *args)
+{
+  struct vm_stat *stat = (struct vm_stat *) args[1];
+  struct block *swap = block_get_role (BLOCK_SWAP);
+
+  if (!check_buffer (stat, sizeof *stat))
+    syscall_exit (f, -1);
+
+  stat->page_faults = exception_page_faults ();
+  stat->swap_reads = swap != NULL ? block_read_cnt (swap) : 0;
+  stat->swap_writes = swap != NULL ? block_write_cnt (swap) : 0;
+}
+
+/* Writes the file or directory open as args[1] to disk, without
+   its metadata if DATA_ONLY.  Returns false for the console or a
+   pipe, which have nothing to write. */
+static void
+syscall_fsync (struct intr_frame *f, uint32_t *args,
+               struct thread *current_thread, bool data_only)
+{
+  int fd = (int) args[1];
+  struct inode *inode;
+
+  f->eax = false;
+  if (fd == 0 || fd == 1 || get_pipe_end (current_thread, fd) != NULL)
+    return;
+  if (!convert_fd_to_inode (&inode, current_thread, fd))
+    syscall_exit (f, -1);
+
+  inode_sync (inode, data_only);
+  f->eax = true;
+}
+
+/* Runs a defragmenter pass and returns the number of blocks it
+   moved. */
+static void
+syscall_defrag (struct intr_frame *f)
+{
+  f->eax = defrag_run ();
+}
+
+/* Sets whether reads and writes of the file open as args[1]
+   bypass the buffer cache.  Fails for anything but a regular
+   file. */
+static void
+syscall_direct_io (struct intr_frame *f, uint32_t *args,
+                   struct thread *current_thread)
+{
+  int fd = (int) args[1];
+  bool direct = args[2] != 0;
+
+  f->eax = false;
+  if (fd < 3 || !check_fd (current_thread, fd)
+      || convert_file_to_dir (current_thread->file_descriptors[fd]) != NULL)
+    return;
+
+  file_set_direct (current_thread->file_descriptors[fd], direct);
+  f->eax = true;
+}